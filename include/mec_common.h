@@ -70,4 +70,17 @@ void track_list_release(track_list_t *list); // 减少引用（计数为0时释
 int track_list_add(track_list_t *list, const target_track_t *track);
 void track_list_clear(track_list_t *list);
 
+// Publish ring: a fixed set of snapshot lists reused once every reader has released them
+#define TRACK_LIST_RING_SIZE 8                 // Published + queued + in-flight readers
+
+typedef struct {
+    track_list_t *lists[TRACK_LIST_RING_SIZE];  // Each holds one reference owned by the ring
+    int next;
+    int capacity;
+} track_list_ring_t;
+
+void track_list_ring_init(track_list_ring_t *ring, int capacity);
+void track_list_ring_destroy(track_list_ring_t *ring);
+track_list_t* track_list_ring_acquire(track_list_ring_t *ring); // 空列表，调用者持有一个引用
+
 #endif // MEC_COMMON_H
\ No newline at end of file
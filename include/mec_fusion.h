@@ -2,6 +2,7 @@
 #define MEC_FUSION_H
 
 #include "mec_common.h"
+#include "mec_geo.h"
 
 // Fusion configuration
 typedef struct {
@@ -10,8 +11,17 @@ typedef struct {
     double velocity_weight;
     double confidence_threshold;
     int max_track_age;
+    char snapshot_path[256];   // Memory-mapped checkpoint file (empty = disabled)
+    int snapshot_interval_ms;  // Minimum interval between checkpoints
+    geo_site_t site;           // Filter runs in this site's ENU metres; input/output stay WGS84
 } fusion_config_t;
 
+// Fusion tick period (20Hz)
+#define FUSION_TICK_MS 50
+
+// Memory-mapped checkpoint of the fused track store (opaque)
+typedef struct fusion_snapshot_t fusion_snapshot_t;
+
 // Kalman filter state
 typedef struct {
     double state[6];      // [x, y, vx, vy, ax, ay]
@@ -20,6 +30,16 @@ typedef struct {
     int initialized;
 } kalman_state_t;
 
+// State transition cached per quantized dt (F, F^T and process noise)
+#define FUSION_DT_QUANTUM_MS 1
+#define FUSION_TRANSITION_CACHE_SIZE 64
+typedef struct {
+    int dt_ms;            // Quantized dt key (0 = empty slot)
+    double F[36];
+    double FT[36];
+    double q;             // Process noise added to the covariance diagonal
+} kalman_transition_t;
+
 // Fused track
 typedef struct {
     int global_id;
@@ -31,6 +51,13 @@ typedef struct {
     struct timeval last_update;
 } fused_track_t;
 
+// Gated measurement/track pair used by frame-level association
+typedef struct {
+    int meas_idx;
+    int track_idx;
+    double dist_sq;
+} fusion_candidate_t;
+
 // Fusion processor context
 typedef struct {
     fusion_config_t config;
@@ -39,7 +66,22 @@ typedef struct {
     int track_count;
     int track_capacity;
     int next_global_id;
-    track_list_t *output_tracks;
+    track_list_t *output_tracks;      // Latest published snapshot (replaced, never mutated)
+    track_list_ring_t output_ring;    // Snapshot lists reused across ticks
+    uint64_t output_version;          // Incremented on every published snapshot
+    pthread_mutex_t output_lock;      // Guards output_tracks / output_version
+    pthread_cond_t output_cond;       // Signalled on publish
+    fusion_snapshot_t *snapshot;
+    struct timeval last_snapshot;
+    kalman_transition_t transition_cache[FUSION_TRANSITION_CACHE_SIZE];
+    // Scratch buffers for frame-level association (reused across frames)
+    double *gate_soa;                 // [x | y | 1/var_x | 1/var_y], track_capacity each
+    unsigned char *track_taken;
+    fusion_candidate_t *candidates;
+    int candidate_capacity;
+    int *meas_match;
+    double *meas_enu;                 // [east | north], meas_capacity each
+    int meas_capacity;
 } fusion_processor_t;
 
 // Fusion module functions
@@ -50,7 +92,13 @@ void fusion_processor_stop(fusion_processor_t *processor);
 int fusion_processor_add_tracks(fusion_processor_t *processor, 
                                const track_list_t *tracks, 
                                int sensor_id);
-track_list_t* fusion_processor_get_tracks(fusion_processor_t *processor);
+int fusion_processor_add_frame(fusion_processor_t *processor,
+                               const track_list_t *tracks,
+                               int sensor_id,
+                               const struct timeval *scan_time);
+track_list_t* fusion_processor_acquire_tracks(fusion_processor_t *processor, uint64_t *version);
+track_list_t* fusion_processor_wait_tracks(fusion_processor_t *processor, uint64_t after, int timeout_ms,
+                                           uint64_t *version);
 
 // Internal fusion functions
 void* fusion_processing_thread(void *arg);
@@ -61,8 +109,15 @@ int associate_tracks(const track_list_t *sensor_tracks,
 int update_fused_track(fused_track_t *fused_track, 
                       const target_track_t *sensor_track);
 int predict_track_state(fused_track_t *track, double dt);
+int fusion_predict_to(fusion_processor_t *processor, fused_track_t *track, const struct timeval *when);
 int initialize_kalman_filter(kalman_state_t *state, const target_track_t *track);
 int update_kalman_filter(kalman_state_t *state, const target_track_t *measurement);
 double calculate_track_distance(const fused_track_t *track1, const target_track_t *track2);
 
+// Checkpointing (fast restart)
+fusion_snapshot_t* fusion_snapshot_open(const char *path, int capacity);
+void fusion_snapshot_close(fusion_snapshot_t *snap);
+int fusion_snapshot_save(fusion_snapshot_t *snap, const fusion_processor_t *processor);
+int fusion_snapshot_restore(fusion_snapshot_t *snap, fusion_processor_t *processor);
+
 #endif // MEC_FUSION_H
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef MEC_GEO_H
+#define MEC_GEO_H
+
+#include "mec_common.h"
+
+/**
+ * @brief 站点本地切平面（ENU）与 WGS84 之间的线性化坐标转换
+ *
+ * 约定：传感器输出的 target_track_t.position 一律为 WGS84 经纬度（度）；
+ * 融合等需要米制的模块在内部转换到站点 ENU。未配置站点原点时退化为恒等映射，
+ * position 中保留本地平面坐标（米），与未标定时的历史行为一致。
+ */
+
+// Site-local tangent plane anchored at the configured origin
+typedef struct {
+    wgs84_coord_t origin;
+    int valid;                 // 0 = no origin configured (identity, positions stay in metres)
+    double lat_per_north;      // Degrees of latitude per metre north
+    double lon_per_east;       // Degrees of longitude per metre east
+    double north_per_lat;      // Metres north per degree of latitude
+    double east_per_lon;       // Metres east per degree of longitude
+} geo_site_t;
+
+// Sensor mount pose, precomputed as one affine map per output frame
+typedef struct {
+    double east;               // Mount position in the site frame (metres)
+    double north;
+    double yaw;                // Heading of the sensor x axis, degrees clockwise from north
+    double enu[6];             // Sensor (x, y) -> ENU: e = [0]x + [1]y + [2], n = [3]x + [4]y + [5]
+    double wgs84[6];           // Sensor (x, y) -> WGS84: lat = [0]x + [1]y + [2], lon = [3]x + [4]y + [5]
+    double altitude;
+    double heading_offset;     // Added to sensor-frame headings (degrees)
+} geo_pose_t;
+
+int geo_site_init(geo_site_t *site, const wgs84_coord_t *origin);
+void geo_site_load(config_t *config, geo_site_t *site);
+void geo_pose_init(geo_pose_t *pose, const geo_site_t *site, double east, double north, double yaw_deg);
+void geo_pose_load(config_t *config, const char *prefix, const geo_site_t *site, geo_pose_t *pose);
+
+// Single-point conversions (a few multiply-adds each)
+static inline void geo_enu_to_wgs84(const geo_site_t *site, double east, double north, wgs84_coord_t *out) {
+    out->latitude = site->origin.latitude + north * site->lat_per_north;
+    out->longitude = site->origin.longitude + east * site->lon_per_east;
+    out->altitude = site->origin.altitude;
+}
+
+static inline void geo_wgs84_to_enu(const geo_site_t *site, const wgs84_coord_t *in, double *east, double *north) {
+    *east = (in->longitude - site->origin.longitude) * site->east_per_lon;
+    *north = (in->latitude - site->origin.latitude) * site->north_per_lat;
+}
+
+static inline void geo_pose_to_wgs84(const geo_pose_t *pose, double x, double y, wgs84_coord_t *out) {
+    const double *w = pose->wgs84;
+    out->latitude = w[0] * x + w[1] * y + w[2];
+    out->longitude = w[3] * x + w[4] * y + w[5];
+    out->altitude = pose->altitude;
+}
+
+// Batch conversions over track lists
+void geo_tracks_sensor_to_wgs84(const geo_pose_t *pose, target_track_t *tracks, int count);
+void geo_tracks_enu_to_wgs84(const geo_site_t *site, target_track_t *tracks, int count);
+void geo_tracks_wgs84_to_enu(const geo_site_t *site, const target_track_t *tracks, int count,
+                             double *east, double *north);
+
+#endif // MEC_GEO_H
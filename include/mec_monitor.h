@@ -3,6 +3,7 @@
 
 #include "mec_common.h"
 #include "mec_fusion.h"
+#include "mec_video.h"
 
 /**
  * @brief 实时监控服务模块
@@ -14,6 +15,7 @@
 typedef struct {
     char socket_path[128];
     fusion_processor_t *fusion_proc; // 需要监控的算法句柄
+    video_pool_t *video_pool;        // 需要监控的相机池（可为 NULL）
 } monitor_config_t;
 
 typedef struct {
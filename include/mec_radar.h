@@ -3,6 +3,57 @@
 
 #include "mec_common.h"
 #include "mec_queue.h"
+#include "mec_geo.h"
+
+// Scan clustering (DBSCAN over position and radial velocity)
+typedef struct {
+    int enabled;
+    double eps;                // Neighbourhood radius (m)
+    double velocity_eps;       // Max radial velocity difference within a cluster (m/s)
+    int min_points;            // Neighbours (incl. self) for a core point
+} radar_cluster_config_t;
+
+// Wire protocol descriptor (one per radar model, see radar_protocol.c)
+typedef enum {
+    RADAR_CHECKSUM_NONE = 0,
+    RADAR_CHECKSUM_XOR,        // 1 byte XOR
+    RADAR_CHECKSUM_SUM8,       // 1 byte modulo-256 sum
+    RADAR_CHECKSUM_CRC16       // 2 byte CRC-16/CCITT-FALSE, protocol byte order
+} radar_checksum_t;
+
+typedef enum {
+    RADAR_FIELD_ID = 0,
+    RADAR_FIELD_RANGE,
+    RADAR_FIELD_ANGLE,
+    RADAR_FIELD_VELOCITY,
+    RADAR_FIELD_RCS,
+    RADAR_FIELD_COUNT
+} radar_field_id_t;
+
+typedef struct {
+    int offset;                // Byte offset (target fields: within the target record)
+    int size;                  // 0 (absent), 1, 2 or 4 bytes
+    int is_signed;
+    double scale;              // value = raw * scale + bias
+    double bias;
+} radar_field_t;
+
+#define RADAR_MAX_SYNC 4
+
+typedef struct {
+    char name[32];
+    unsigned char sync[RADAR_MAX_SYNC];
+    int sync_len;
+    int big_endian;
+    radar_field_t count;       // Target count in the header (size 0: always target_count)
+    int target_count;
+    int max_targets;
+    int target_offset;         // First target record, from frame start
+    int target_stride;
+    radar_field_t fields[RADAR_FIELD_COUNT];
+    radar_checksum_t checksum; // Trails the targets
+    int checksum_start;        // First byte covered by the checksum
+} radar_protocol_t;
 
 // Radar configuration
 typedef struct {
@@ -12,10 +63,17 @@ typedef struct {
     double range_resolution;
     double angle_resolution;
     double max_range;
+    int scan_gap_ms;           // Silence longer than this closes the current scan (0: publish per read)
+    radar_cluster_config_t cluster;
+    char record_path[256];     // Raw byte capture file (empty: recording off)
+    radar_protocol_t protocol;
+    geo_pose_t pose;           // Mount pose: sensor frame -> site ENU / WGS84
     mec_queue_t *target_queue; // 目标消息队列
 } radar_config_t;
 
 // Raw radar data structure
+#define RADAR_TARGET_ID_NONE (-1)   // Protocol has no ID field; numbered per scan by radar_scan_add
+
 typedef struct {
     int target_id;
     double range;
@@ -25,14 +83,53 @@ typedef struct {
     struct timeval timestamp;
 } radar_detection_t;
 
+#define RADAR_RX_BUFFER_SIZE  8192  // Also the largest supported frame
+#define RADAR_MAX_DETECTIONS  256   // Decoded per read call
+#define RADAR_SCAN_GAP_MS     20    // Default inter-scan silence
+
+typedef struct radar_clusterer_t radar_clusterer_t;
+
 // Radar processing context
 typedef struct {
     radar_config_t config;
-    thread_context_t thread_ctx;
-    track_list_t *output_tracks;
+    pthread_mutex_t lock;           // Guards output_tracks
+    track_list_t *output_tracks;    // Latest published scan (replaced, never mutated)
+    track_list_ring_t output_ring;  // Scan lists reused once the queue and readers release them
     int fd;  // File descriptor for radar device
+
+    // Receive buffer: filled by large non-blocking reads, parsed in place
+    unsigned char rx_buf[RADAR_RX_BUFFER_SIZE];
+    size_t rx_len;
+    long frames_decoded;
+    long detections_decoded;
+    long checksum_errors;
+    long bytes_discarded;           // Noise skipped while searching for sync
+
+    // Scan assembly: detections of one radar cycle are published together
+    radar_detection_t *scan;        // Pending scan detections
+    int scan_count;
+    int scan_capacity;
+    struct timeval scan_time;       // Arrival of the scan's first frame
+    struct timeval last_arrival;
+    long scans_published;
+    radar_clusterer_t *clusterer;   // NULL when clustering is disabled
+    long detections_in;             // Detections entering the scan stage
+    long objects_out;               // Tracks published after clustering
+    FILE *record;                   // Raw byte capture (NULL when off)
 } radar_processor_t;
 
+// Raw capture file: "MECRADR1" header, then records of
+// [u64 arrival time in us, LE][u16 length, LE][bytes]
+#define RADAR_RECORD_MAGIC    "MECRADR1"
+
+typedef enum {
+    RADAR_REPLAY_PTY = 0,      // Write to a pseudo-terminal at recorded pace (full serial path)
+    RADAR_REPLAY_REALTIME,     // Feed the parser directly at recorded pace
+    RADAR_REPLAY_FAST          // Feed the parser directly as fast as possible
+} radar_replay_mode_t;
+
+typedef struct radar_replay_t radar_replay_t;
+
 // Radar module functions
 radar_processor_t* radar_processor_create(const radar_config_t *config);
 void radar_processor_destroy(radar_processor_t *processor);
@@ -40,12 +137,66 @@ int radar_processor_start(radar_processor_t *processor);
 void radar_processor_stop(radar_processor_t *processor);
 track_list_t* radar_processor_get_tracks(radar_processor_t *processor);
 
+#define RADAR_MAX_DEVICES     8
+
+// Shared I/O thread: one epoll loop drives every configured radar
+typedef struct {
+    radar_processor_t *radars[RADAR_MAX_DEVICES];
+    int radar_count;
+    thread_context_t thread_ctx;
+    int epoll_fd;
+    int wake_fd;                    // eventfd used to interrupt epoll_wait on stop
+    radar_replay_t *replays[RADAR_MAX_DEVICES];  // Replay source per radar (NULL: live device)
+} radar_io_t;
+
+radar_io_t* radar_io_create(config_t *config, mec_queue_t *target_queue);
+void radar_io_destroy(radar_io_t *io);
+int radar_io_start(radar_io_t *io);
+void radar_io_stop(radar_io_t *io);
+void radar_io_report(radar_io_t *io);
+
+// Raw capture and replay
+FILE* radar_record_open(const char *path);
+int radar_record_write(FILE *file, const struct timeval *arrival, const unsigned char *data, size_t len);
+void radar_record_close(FILE *file);
+radar_replay_t* radar_replay_create(const char *path, radar_replay_mode_t mode, int loop);
+void radar_replay_destroy(radar_replay_t *replay);
+const char* radar_replay_device(const radar_replay_t *replay);
+int radar_replay_start(radar_replay_t *replay, radar_processor_t *processor);
+void radar_replay_stop(radar_replay_t *replay);
+int radar_replay_finished(const radar_replay_t *replay);
+
+// Protocol descriptors
+void radar_protocol_legacy(radar_protocol_t *protocol);
+int radar_protocol_load(config_t *config, const char *name, radar_protocol_t *protocol);
+int radar_protocol_frame_length(const radar_protocol_t *protocol, const unsigned char *frame, size_t available);
+int radar_protocol_verify(const radar_protocol_t *protocol, const unsigned char *frame, int length);
+int radar_protocol_decode(const radar_protocol_t *protocol, const unsigned char *frame, int length,
+                          const struct timeval *arrival, radar_detection_t *detections, int max_detections);
+
+// Scan clustering
+radar_clusterer_t* radar_clusterer_create(const radar_cluster_config_t *config);
+void radar_clusterer_destroy(radar_clusterer_t *clusterer);
+int radar_cluster_scan(radar_clusterer_t *clusterer, const radar_detection_t *detections, int count,
+                       const radar_config_t *config, const struct timeval *scan_time, track_list_t *out);
+
 // Internal processing functions
-void* radar_processing_thread(void *arg);
-int radar_read_data(radar_processor_t *processor, radar_detection_t *detection);
+int radar_read_data(radar_processor_t *processor, radar_detection_t *detections, int max_detections);
+int radar_processor_feed(radar_processor_t *processor, const unsigned char *data, size_t len,
+                         const struct timeval *arrival);
+int radar_parse_buffer(radar_processor_t *processor, const struct timeval *arrival,
+                       radar_detection_t *detections, int max_detections);
+int radar_scan_add(radar_processor_t *processor, const radar_detection_t *detections, int count);
+int radar_scan_flush(radar_processor_t *processor);
+long radar_scan_timeout_ms(const radar_processor_t *processor, const struct timeval *now);
 int radar_convert_to_track(const radar_detection_t *detection, 
                           const radar_config_t *config, 
                           target_track_t *track);
 int radar_polar_to_cartesian(double range, double angle, double *x, double *y);
 
+// Batch polar -> Cartesian over SoA arrays (0.1 deg lookup table, no libm calls)
+#define RADAR_POLAR_BATCH 64
+void radar_polar_to_cartesian_batch(const double *restrict range, const double *restrict angle,
+                                    double *restrict x, double *restrict y, int count);
+
 #endif // MEC_RADAR_H
\ No newline at end of file
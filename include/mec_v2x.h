@@ -2,6 +2,7 @@
 #define MEC_V2X_H
 
 #include "mec_common.h"
+#include "mec_fusion.h"
 
 /**
  * @file mec_v2x.h
@@ -11,7 +12,24 @@
  */
 
 #define V2X_MSG_RSM 0x01
-#define V2X_PROTOCOL_VER 0x01
+#define V2X_PROTOCOL_VER 0x03
+
+/**
+ * 线上格式为显式逐字节打包的大端序列（下列结构体仅描述字段，不直接映射缓冲区）：
+ * 头部 28 字节（含分片与目标数）+ 每个目标 16 字节。
+ * 一个快照可拆分为多个分片，各分片头部携带相同的快照序号。
+ */
+#define V2X_HEADER_SIZE      28
+#define V2X_PARTICIPANT_SIZE 16
+#define V2X_MAX_PACKET       2048
+#define V2X_MAX_FRAGMENTS    32         // Per snapshot
+
+// Header flags
+#define V2X_FLAG_KEYFRAME    0x01       // Complete participant set
+#define V2X_FLAG_DELTA       0x02       // Only participants changed since keyframe base_seq
+
+// Participant type marking a keyframe participant that has disappeared (delta only)
+#define V2X_TYPE_REMOVED     0xFF
 
 /**
  * @brief V2X 消息头部 (简化的标准头)
@@ -22,6 +40,12 @@ typedef struct {
     uint8_t msg_type;   // 消息类型 (例如 RSM)
     uint32_t device_id; // RSU 设备 ID
     uint64_t timestamp; // 毫秒级时间戳
+    uint32_t seq;       // 快照序号（同一快照的全部分片相同）
+    uint32_t base_seq;  // 增量所参照的关键帧序号（关键帧等于 seq）
+    uint8_t frag_index; // 分片序号
+    uint8_t frag_count; // 分片总数
+    uint8_t flags;      // V2X_FLAG_*
+    uint16_t count;     // 本分片的目标数
 } v2x_header_t;
 
 /**
@@ -38,14 +62,122 @@ typedef struct {
 } v2x_rsm_participant_t;
 
 /**
- * @brief 序列化函数：将航迹列表转换为二进制 V2X 包
+ * @brief 序列化函数：将航迹列表转换为单个关键帧 V2X 包（不分片）
  * 
  * @param tracks 融合后的航迹列表
  * @param rsu_id 本机 RSU 标识
  * @param out_buf 输出缓冲区
  * @param out_len 输入为缓冲区大小，输出为实际写入长度
- * @return 0:成功, -1:空间不足或出错
+ * @return 0:成功, -1:空间不足或出错（分片编码见 v2x_output_encode）
  */
 int v2x_encode_rsm(const track_list_t *tracks, uint32_t rsu_id, uint8_t *out_buf, int *out_len);
 
+// Field-level packing shared by the single-packet and fragmenting encoders
+void v2x_encode_header(uint8_t *buf, const v2x_header_t *header);
+void v2x_quantize_track(const target_track_t *track, v2x_rsm_participant_t *participant);
+void v2x_pack_participant(uint8_t *buf, const v2x_rsm_participant_t *participant);
+
+/**
+ * @brief 解析 RSM 报文（用于回环校验与接收端）
+ *
+ * @param participants 输出目标（可为 NULL，仅校验头部与长度）
+ * @return 报文中的目标数，格式错误返回 -1
+ */
+int v2x_decode_rsm(const uint8_t *buf, int len, v2x_header_t *header,
+                   v2x_rsm_participant_t *participants, int max_participants);
+
+// Compact private bit-packed participant list (UPER-style packing, NOT the standard
+// RSM schema; not interoperable with GB/T 31024 / J2735 decoders, not on the wire)
+#define V2X_COMPACT_MAX_PARTICIPANTS 16         // 4-bit count field (1..16)
+#define V2X_COMPACT_MAX_BYTES        248        // 76 header bits + 16 x 119 participant bits, octet aligned
+
+int v2x_compact_encode(uint8_t msg_cnt, uint32_t rsu_id, const v2x_rsm_participant_t *participants,
+                       int count, uint8_t *buf, int len);
+int v2x_compact_decode(const uint8_t *buf, int len, uint8_t *msg_cnt, uint32_t *rsu_id,
+                       v2x_rsm_participant_t *participants, int max_participants);
+
+// UDP publisher: one pre-connected socket per destination, sendmmsg batching
+#define V2X_MAX_DESTS 8
+
+typedef struct {
+    char host[64];                              // Unicast or multicast (224.0.0.0/4) IPv4 address
+    int port;
+    int socket_fd;                              // Connected datagram socket
+    long packets_sent;
+    long packets_dropped;                       // Not accepted by the kernel (buffer full or error)
+} v2x_dest_t;
+
+typedef struct {
+    v2x_dest_t dests[V2X_MAX_DESTS];
+    int dest_count;
+    long batches;                               // sendmmsg calls
+    double latency_us_total;                    // Encode -> send, summed per packet
+    double latency_us_max;
+    long latency_samples;
+} v2x_udp_t;
+
+// V2X output stage: encodes each new fusion snapshot into a preallocated packet ring
+#define V2X_OUTPUT_RING 64                      // >= 2 * V2X_MAX_FRAGMENTS: a snapshot never overwrites the previous one
+#define V2X_SNAPSHOT_MAX ((V2X_MAX_PACKET - V2X_HEADER_SIZE) / V2X_PARTICIPANT_SIZE * V2X_MAX_FRAGMENTS)
+#define V2X_KEYFRAME_SLOTS 8192                 // Power of two, >= 2 * V2X_SNAPSHOT_MAX (load factor <= 0.5)
+
+typedef struct {
+    _Alignas(64) uint8_t data[V2X_MAX_PACKET];  // Cache-line aligned packet bytes
+    int len;
+    uint64_t version;                           // Fusion snapshot version it encodes
+    uint64_t encoded_us;                        // CLOCK_MONOTONIC at encode, for send latency
+} v2x_packet_t;
+
+typedef struct {
+    uint32_t rsu_id;
+    fusion_processor_t *fusion_proc;            // Snapshot source
+    v2x_udp_t *publisher;                       // NULL: encode only
+    int max_packet;                             // Fragment size limit in bytes (0: 1400, capped at V2X_MAX_PACKET)
+    int delta;                                  // Send only participants changed since the last keyframe
+    int keyframe_interval;                      // Snapshots per keyframe in delta mode (0: 10)
+} v2x_output_config_t;
+
+// Participant record as last sent in a keyframe (open addressing by target id)
+typedef struct {
+    uint32_t gen;                               // Keyframe generation the slot belongs to (0: empty)
+    uint32_t seen_seq;                          // Last delta snapshot that carried or matched this id
+    uint16_t id;
+    uint8_t packed[V2X_PARTICIPANT_SIZE];       // Wire bytes, compared to detect changes
+} v2x_keyframe_slot_t;
+
+typedef struct {
+    v2x_output_config_t config;
+    thread_context_t thread_ctx;
+    v2x_packet_t *ring;                         // V2X_OUTPUT_RING slots, allocated once
+    uint64_t head;                              // Packets encoded so far (slot = head % ring size)
+    uint64_t last_version;
+    uint32_t seq;                               // Snapshot sequence number on the wire
+    uint32_t keyframe_seq;
+    uint32_t keyframe_gen;
+    int since_keyframe;                         // Delta snapshots since keyframe_seq
+    v2x_keyframe_slot_t *keyframe;              // V2X_KEYFRAME_SLOTS entries, allocated once
+    int *keyframe_slots;                        // Occupied slot indices of the current keyframe
+    int keyframe_count;
+    long snapshots;
+    long keyframes;
+    long fragments;
+    long truncated;                             // Participants dropped by the V2X_MAX_FRAGMENTS limit
+    long bytes;
+    double encode_us;                           // Cumulative encode time
+} v2x_output_t;
+
+v2x_output_t* v2x_output_create(const v2x_output_config_t *config);
+void v2x_output_destroy(v2x_output_t *output);
+int v2x_output_start(v2x_output_t *output);
+void v2x_output_stop(v2x_output_t *output);
+int v2x_output_encode(v2x_output_t *output, const track_list_t *tracks, uint64_t version,
+                      const v2x_packet_t **packets);
+void v2x_output_report(v2x_output_t *output);
+
+v2x_udp_t* v2x_udp_create(config_t *config);
+void v2x_udp_destroy(v2x_udp_t *udp);
+int v2x_udp_add_dest(v2x_udp_t *udp, const char *host, int port, int ttl, int loop);
+int v2x_udp_send(v2x_udp_t *udp, const v2x_packet_t *const *packets, int count);
+void v2x_udp_report(v2x_udp_t *udp);
+
 #endif // MEC_V2X_H
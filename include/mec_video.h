@@ -3,23 +3,104 @@
 
 #include "mec_common.h"
 #include "mec_queue.h"
+#include "mec_geo.h"
+
+// Detector backend
+typedef enum {
+    VIDEO_DETECTOR_PLACEHOLDER = 0,  // Fixed demo detections, no model
+    VIDEO_DETECTOR_DNN = 1           // OpenCV DNN on CPU, local ONNX model
+} video_detector_backend_t;
+
+typedef struct {
+    video_detector_backend_t backend;
+    char model_path[256];
+    int input_width;             // Network input size
+    int input_height;
+    int batch_size;              // Max frames per forward pass
+    float score_threshold;
+    float nms_threshold;
+} video_detector_config_t;
+
+// One frame submitted to the detector
+typedef struct {
+    const void *frame;           // cv::Mat*
+    int roi_x;                   // Region of the frame to run detection on
+    int roi_y;
+    int roi_width;
+    int roi_height;
+    int skip;                    // Motion gate: nothing changed, don't detect
+    int cropped;                 // Motion gate: ROI shrunk to the moving tiles
+    int frame_width;             // Native frame size (frame may be governor-downscaled)
+    int frame_height;
+} video_detect_input_t;
+
+// Motion gate: downscaled frame differencing over a tile grid
+typedef struct {
+    int enabled;
+    int width;                   // Downscaled width for differencing
+    int tiles_x;
+    int tiles_y;
+    int pixel_threshold;         // Grey-level change counted as motion
+    double tile_ratio;           // Fraction of changed pixels that marks a tile active
+    int refresh_frames;          // Force a full detection at least every N frames
+} video_motion_config_t;
+
+typedef struct video_detector_t video_detector_t;
+
+// Frame source
+typedef enum {
+    VIDEO_SOURCE_RTSP = 0,
+    VIDEO_SOURCE_FILE = 1,           // Local video file
+    VIDEO_SOURCE_IMAGES = 2          // Directory of images, played in name order
+} video_source_type_t;
+
+typedef enum {
+    VIDEO_PLAYBACK_REALTIME = 0,     // Paced at the source frame rate
+    VIDEO_PLAYBACK_FAST = 1          // As fast as processing allows, no frame dropped
+} video_playback_t;
 
 // Video stream configuration
 typedef struct {
     char rtsp_url[256];
+    video_source_type_t source_type;
+    char source_path[256];     // File or image directory for offline sources
+    video_playback_t playback; // Offline sources only
+    int loop;                  // Offline sources: restart at the end
     int width;
     int height;
     int fps;
     int camera_id;
+    double track_gate;         // Tracker association radius (normalized, 0 = default)
+    int track_max_misses;      // Frames a track may coast unmatched (0 = default)
+    int track_max_coast_ms;    // How long a track may coast outside the detected area (0 = default)
+    video_detector_config_t detector; // Standalone mode only; pool workers own their detectors
+    video_motion_config_t motion;
+    int frame_pool_size;       // Frame buffers per camera (0 = default)
+    int priority;              // Governor: 0 = critical (never degraded), larger sheds first
+    int min_fps;               // Governor floor for the processed frame rate
+    double min_scale;          // Governor floor for the input scale
     mec_queue_t *target_queue; // 目标消息队列
 } video_config_t;
 
 // Perspective transformation parameters
 typedef struct {
-    double matrix[9];  // 3x3 transformation matrix
+    double matrix[9];  // 3x3 transformation matrix (pixels -> local east/north metres)
     int calibrated;
+    geo_site_t site;       // Linearization at the local metric origin (invalid: output stays in metres)
+    int grid_cell;         // Lookup grid spacing in pixels (0 = direct homography)
 } perspective_transform_t;
 
+// Precomputed pixel -> WGS84 lookup grid (bilinearly interpolated)
+typedef struct {
+    int width;         // Frame size the grid was built for
+    int height;
+    int cell;
+    float inv_cell;
+    int cols;          // Node counts
+    int rows;
+    float *nodes;      // [north, east] offsets from origin per node (degrees, or metres without origin)
+} perspective_grid_t;
+
 // Detection region
 typedef struct {
     int enabled;
@@ -27,16 +108,182 @@ typedef struct {
     image_coord_t points[10];  // Max 10 points for polygon
 } detection_region_t;
 
+// Pipeline stages timed per camera
+typedef enum {
+    VIDEO_STAGE_DECODE = 0,       // Source read / decode
+    VIDEO_STAGE_PREPARE,          // Scale, region mask, motion gate
+    VIDEO_STAGE_DETECT,           // Detector (batched forward split across cameras)
+    VIDEO_STAGE_PUBLISH,          // Tracking, transform, queue push
+    VIDEO_STAGE_COUNT
+} video_stage_t;
+
+// Per-camera runtime statistics
+typedef struct {
+    long frames_captured;
+    long frames_processed;
+    long frames_dropped;          // Captured frames overwritten before processing
+    long frames_skipped;          // No motion: detection skipped, tracks predicted
+    long frames_cropped;          // Detection limited to moving tiles
+    long frames_throttled;        // Not processed because of the governor frame-rate cap
+    double total_latency_ms;      // Cumulative capture-to-publish latency
+    long window_decoded;
+    double window_stage_ms[VIDEO_STAGE_COUNT]; // Time spent per stage in the report window
+    double stage_fps[VIDEO_STAGE_COUNT];       // Per-stage throughput over the last window
+    int end_of_stream;            // Offline source finished (no loop)
+    double fps;                   // Processed FPS over the last report window
+    double avg_latency_ms;        // Capture-to-publish latency over the last report window
+    double max_latency_ms;
+    long window_frames;
+    double window_latency_ms;
+    struct timeval window_start;
+} video_camera_stats_t;
+
+// Image-space tracklet (normalized coordinates, constant-velocity model)
+typedef struct {
+    int id;
+    double x, y;            // Predicted/updated position
+    double vx, vy;          // Velocity per second
+    int hits;
+    int misses;
+    int matched;            // Associated in the current frame
+    struct timeval last_seen; // Capture time of the last associated detection
+    target_track_t last;    // Last associated detection
+} video_tracklet_t;
+
+// Normalized frame rectangle [x0, x1) x [y0, y1)
+typedef struct {
+    double x0, y0, x1, y1;
+} video_norm_rect_t;
+
+// Per-camera multi-object tracker; IDs are local to the instance
+typedef struct {
+    video_tracklet_t *tracks;
+    int count;
+    int capacity;
+    int next_id;
+    double gate;
+    int max_misses;
+    double max_coast;       // Seconds an unobserved track is still predicted
+    struct timeval last_time;
+    int grid_dim;           // Buckets per axis (cell size ~ gate)
+    int *cell_head;         // grid_dim * grid_dim chain heads
+    int *next_in_cell;      // Per-tracklet chain links
+    void *candidates;       // Gated (detection, track) pairs
+    int candidate_capacity;
+    int *det_match;         // Per-detection assigned tracklet
+    int det_capacity;
+} video_tracker_t;
+
+#define VIDEO_TRACK_GATE        0.05
+#define VIDEO_TRACK_MAX_MISSES  5
+#define VIDEO_TRACK_MAX_COAST_MS 2000
+
+// Governor level applied to one camera
+typedef struct {
+    double fps_limit;          // Processed frame-rate cap (>= config fps means uncapped)
+    double scale;              // Input scale before detection (1.0 = native)
+} video_govern_state_t;
+
+// Reference-counted frame buffer from a fixed-size aligned pool
+struct video_frame_pool_t;
+
+typedef struct video_frame_t {
+    unsigned char *data;       // 64-byte aligned pixels
+    int width;
+    int height;
+    int channels;              // 8-bit channels
+    size_t step;               // Row stride in bytes (64-byte aligned)
+    struct timeval capture_time;
+    int ref_count;             // Guarded by pool->lock
+    struct video_frame_pool_t *pool;
+    struct video_frame_t *next_free;
+} video_frame_t;
+
+typedef struct video_frame_pool_t {
+    video_frame_t *frames;
+    int count;
+    int width;
+    int height;
+    int channels;
+    size_t step;
+    size_t frame_bytes;
+    unsigned char *storage;    // Single aligned block for all frames
+    video_frame_t *free_list;
+    int outstanding;           // Frames currently referenced
+    int retired;               // Destroyed by owner; freed when outstanding drops to 0
+    pthread_mutex_t lock;
+} video_frame_pool_t;
+
+#define VIDEO_FRAME_POOL_SIZE 4
+
+// C++ side runtime state (capture handle, frame handoff), opaque to C
+struct video_runtime_t;
+
 // Video processing context
 typedef struct {
     video_config_t config;
     perspective_transform_t transform;
     detection_region_t regions[4];  // Max 4 regions
     int region_count;
-    thread_context_t thread_ctx;
-    track_list_t *output_tracks;
+    thread_context_t thread_ctx;    // Capture thread
+    thread_context_t process_ctx;   // Processing thread (standalone mode only)
+    track_list_t *output_tracks;    // Latest published frame (replaced, never mutated)
+    track_list_ring_t output_ring;  // Per-camera frame lists reused once consumers release them
+    video_camera_stats_t stats;
+    perspective_grid_t *grid;       // Built lazily from transform once the frame size is known
+    video_tracker_t *tracker;
+    video_detector_t *detector;     // Standalone mode only
+    video_govern_state_t govern;    // Set by the pool governor
+    struct video_runtime_t *runtime;
 } video_processor_t;
 
+// Multi-camera pool: one capture thread per camera, shared processing workers
+#define VIDEO_MAX_CAMERAS 16
+
+struct video_pool_t;
+
+// Load governor: sheds frame rate, then resolution, from low-priority cameras
+typedef struct {
+    int enabled;
+    int interval_ms;           // Evaluation period
+    double cpu_high;           // Busy fraction that counts as pressure
+    double cpu_low;            // Busy fraction below which levels are restored
+    double latency_ms;         // Per-camera latency budget
+} video_governor_config_t;
+
+typedef struct {
+    video_governor_config_t config;
+    thread_context_t thread_ctx;
+    struct video_pool_t *pool;
+    unsigned long long prev_idle;
+    unsigned long long prev_total;
+    long prev_frames[VIDEO_MAX_CAMERAS];
+    double prev_latency_ms[VIDEO_MAX_CAMERAS];
+    double cpu_busy;           // Last measured busy fraction
+} video_governor_t;
+
+typedef struct {
+    thread_context_t thread_ctx;
+    struct video_pool_t *pool;
+    int index;
+    video_detector_t *detector;     // Not thread-safe: one per worker
+} video_worker_t;
+
+typedef struct video_pool_t {
+    video_processor_t *cameras[VIDEO_MAX_CAMERAS];
+    int camera_count;
+    video_worker_t *workers;
+    int worker_count;
+    video_detector_config_t detector_config;
+    video_governor_t governor;
+    int ready[VIDEO_MAX_CAMERAS];   // FIFO of camera indices with a pending frame
+    int ready_head;
+    int ready_count;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    volatile int running;
+} video_pool_t;
+
 // Video module functions
 video_processor_t* video_processor_create(const video_config_t *config);
 void video_processor_destroy(video_processor_t *processor);
@@ -44,17 +291,67 @@ int video_processor_start(video_processor_t *processor);
 void video_processor_stop(video_processor_t *processor);
 int video_processor_set_transform(video_processor_t *processor, const perspective_transform_t *transform);
 int video_processor_add_region(video_processor_t *processor, const detection_region_t *region);
+int video_region_contains(const video_processor_t *processor, int x, int y);
 track_list_t* video_processor_get_tracks(video_processor_t *processor);
+void video_processor_get_stats(video_processor_t *processor, video_camera_stats_t *stats);
+void video_processor_get_govern(video_processor_t *processor, video_govern_state_t *state);
+void video_processor_set_govern(video_processor_t *processor, const video_govern_state_t *state);
+
+// Multi-camera pool functions
+video_pool_t* video_pool_create(config_t *config, mec_queue_t *target_queue);
+void video_pool_destroy(video_pool_t *pool);
+int video_pool_start(video_pool_t *pool);
+void video_pool_stop(video_pool_t *pool);
+void video_pool_report(video_pool_t *pool);
+int video_pool_finished(video_pool_t *pool);
+
+// Load governor
+void video_governor_config_load(config_t *config, video_governor_config_t *out);
+int video_governor_start(video_governor_t *governor, struct video_pool_t *pool);
+void video_governor_stop(video_governor_t *governor);
+void* video_governor_thread(void *arg);
 
 // Coordinate transformation
 int transform_image_to_wgs84(const perspective_transform_t *transform, 
                            const image_coord_t *image_coord, 
                            wgs84_coord_t *wgs84_coord);
+int transform_tracks_to_wgs84(const perspective_transform_t *transform,
+                              const perspective_grid_t *grid,
+                              track_list_t *tracks,
+                              int frame_width, int frame_height);
+perspective_grid_t* perspective_grid_create(const perspective_transform_t *transform, int width, int height, int cell);
+void perspective_grid_destroy(perspective_grid_t *grid);
+
+// Detector
+void video_detector_config_load(config_t *config, video_detector_config_t *out);
+video_detector_t* video_detector_create(const video_detector_config_t *config);
+void video_detector_destroy(video_detector_t *detector);
+int video_detector_batch_size(const video_detector_t *detector);
+int video_detector_detect(video_detector_t *detector, const video_detect_input_t *inputs,
+                          track_list_t **outputs, int count);
+
+// Frame buffer pool
+video_frame_pool_t* video_frame_pool_create(int count, int width, int height, int channels);
+void video_frame_pool_destroy(video_frame_pool_t *pool);
+video_frame_t* video_frame_acquire(video_frame_pool_t *pool);
+void video_frame_retain(video_frame_t *frame);
+void video_frame_release(video_frame_t *frame);
+
+// Image-space tracker
+video_tracker_t* video_tracker_create(double gate, int max_misses, int max_coast_ms);
+void video_tracker_destroy(video_tracker_t *tracker);
+int video_tracker_update(video_tracker_t *tracker, track_list_t *detections,
+                         const video_norm_rect_t *observed, const struct timeval *frame_time);
+int video_tracker_predict(video_tracker_t *tracker, track_list_t *tracks, const struct timeval *frame_time);
 
 // Internal processing functions
 void* video_processing_thread(void *arg);
-int process_video_frame(video_processor_t *processor, const void *frame_data);
-int detect_targets(const void *frame_data, int width, int height, track_list_t *tracks);
-int track_targets(track_list_t *previous_tracks, track_list_t *current_tracks);
+void* video_capture_thread(void *arg);
+void* video_worker_thread(void *arg);
+int video_frame_prepare(video_processor_t *processor, const void *frame_data, video_detect_input_t *input);
+int video_frame_publish(video_processor_t *processor, const video_detect_input_t *input,
+                        track_list_t *tracks, const struct timeval *capture_time);
+int process_video_frame(video_processor_t *processor, video_detector_t *detector,
+                        const void *frame_data, const struct timeval *capture_time);
 
 #endif // MEC_VIDEO_H
\ No newline at end of file
@@ -0,0 +1,17 @@
+#ifndef MEC_BENCH_H
+#define MEC_BENCH_H
+
+#include "mec_radar.h"
+#include "mec_v2x.h"
+
+/**
+ * @brief 离线基准与编解码自检（mec_bench，不随 mec_system 发布）
+ *
+ * 每个入口返回 0 表示校验全部通过，ctest 以退出码判定。
+ */
+int radar_polar_benchmark(int points);
+int v2x_output_benchmark(int targets);
+int v2x_udp_benchmark(int packets);
+int v2x_compact_benchmark(int participants);
+
+#endif // MEC_BENCH_H
@@ -0,0 +1,140 @@
+#include "bench.h"
+
+/**
+ * @file bench_compact.c
+ * @brief 紧凑私有编码往返语料与吞吐基准
+ */
+
+#define COMPACT_BENCH_ROUNDS   2000
+#define COMPACT_CORPUS_RANDOM  1000
+
+static int participant_equal(const v2x_rsm_participant_t *a, const v2x_rsm_participant_t *b) {
+    return a->target_id == b->target_id && a->type == b->type && a->lat == b->lat && a->lon == b->lon &&
+           a->speed == b->speed && a->heading == b->heading && a->confidence == b->confidence;
+}
+
+static void random_participant(unsigned int *seed, v2x_rsm_participant_t *p) {
+    p->target_id = (uint16_t)rand_r(seed);
+    p->type = (uint8_t)(rand_r(seed) % 5);
+    p->lat = (int32_t)((int64_t)rand_r(seed) % 1800000002LL - 900000000LL);
+    p->lon = (int32_t)(((int64_t)rand_r(seed) * 2) % 3600000001LL - 1799999999LL);
+    p->speed = (uint16_t)(rand_r(seed) % 8192);
+    p->heading = (uint16_t)(rand_r(seed) % 28801);
+    p->confidence = (uint8_t)(rand_r(seed) % 201);
+}
+
+/**
+ * @brief 往返校验语料：固定码流、约束边界、越界夹取、随机取值与截断输入
+ * @return 不一致的用例数
+ */
+static int compact_corpus_check(void) {
+    int failures = 0;
+    uint8_t buf[V2X_COMPACT_MAX_BYTES];
+    v2x_rsm_participant_t decoded[V2X_COMPACT_MAX_PARTICIPANTS];
+    uint8_t msg_cnt;
+    uint32_t rsu_id;
+
+    // 1. 固定码流（逐位手工推导），校验位序与字段顺序
+    static const uint8_t golden[] = {
+        0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xAB, 0xCD, 0x02, 0x12, 0x34, 0x9A,
+        0xDC, 0xFD, 0x31, 0x61, 0x55, 0x56, 0xAE, 0x1F, 0x43, 0x84, 0x16, 0x80
+    };
+    v2x_rsm_participant_t golden_ptc = { 0x1234, 2, 399087000, 1163975000, 500, 7200, 180 };
+    int len = v2x_compact_encode(5, 0xABCD, &golden_ptc, 1, buf, sizeof(buf));
+    if (len != (int)sizeof(golden) || memcmp(buf, golden, sizeof(golden)) != 0) {
+        LOG_ERROR("Compact: golden vector mismatch (%d bytes)", len);
+        failures++;
+    }
+
+    // 2. 约束边界与越界夹取：{ 输入, 期望解码结果 }
+    static const v2x_rsm_participant_t edges[][2] = {
+        { { 0, 0, -900000000, -1799999999, 0, 0, 0 }, { 0, 0, -900000000, -1799999999, 0, 0, 0 } },
+        { { 65535, 4, 900000001, 1800000001, 8191, 28800, 200 },
+          { 65535, 4, 900000001, 1800000001, 8191, 28800, 200 } },
+        { { 1, 9, -2000000000, 2100000000, 65535, 65535, 255 },
+          { 1, 4, -900000000, 1800000001, 8191, 28800, 200 } },
+    };
+    for (int i = 0; i < (int)(sizeof(edges) / sizeof(edges[0])); i++) {
+        len = v2x_compact_encode(127, 0xFFFFFFFF, &edges[i][0], 1, buf, sizeof(buf));
+        if (v2x_compact_decode(buf, len, &msg_cnt, &rsu_id, decoded, 1) != 1 || msg_cnt != 127 ||
+            rsu_id != 0xFFFFFFFF || !participant_equal(&decoded[0], &edges[i][1])) {
+            LOG_ERROR("Compact: edge case %d mismatch", i);
+            failures++;
+        }
+    }
+
+    // 3. 随机取值，每条消息 1..16 个目标；并校验截断输入与不足的输出缓冲区被拒绝
+    unsigned int seed = 2024;
+    v2x_rsm_participant_t corpus[V2X_COMPACT_MAX_PARTICIPANTS];
+    for (int i = 0; i < COMPACT_CORPUS_RANDOM; i++) {
+        int count = i % V2X_COMPACT_MAX_PARTICIPANTS + 1;
+        for (int k = 0; k < count; k++) random_participant(&seed, &corpus[k]);
+
+        len = v2x_compact_encode((uint8_t)i, (uint32_t)i * 2654435761u, corpus, count, buf, sizeof(buf));
+        int n = v2x_compact_decode(buf, len, &msg_cnt, &rsu_id, decoded, V2X_COMPACT_MAX_PARTICIPANTS);
+        int ok = n == count && msg_cnt == (uint8_t)(i & 0x7F) && rsu_id == (uint32_t)i * 2654435761u;
+        for (int k = 0; ok && k < count; k++) ok = participant_equal(&corpus[k], &decoded[k]);
+        ok = ok && v2x_compact_decode(buf, len - 1, NULL, NULL, decoded, V2X_COMPACT_MAX_PARTICIPANTS) < 0;
+        ok = ok && v2x_compact_encode((uint8_t)i, 0, corpus, count, buf, len - 1) < 0;
+        ok = ok && v2x_compact_encode((uint8_t)i, 0, corpus, count, buf, i % 12) < 0;   // 远小于所需长度
+        if (!ok) {
+            LOG_ERROR("Compact: random case %d (%d participants) mismatch", i, count);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+/**
+ * @brief 紧凑编码基准与往返校验（mec_bench compact）
+ *
+ * 先运行往返语料，再将 participants 个目标按每条 16 个编码为若干 RSM，
+ * 输出每快照的编码/解码耗时与每目标位数。
+ */
+int v2x_compact_benchmark(int participants) {
+    if (participants <= 0) return -1;
+
+    int failures = compact_corpus_check();
+    LOG_INFO("Compact Bench: round-trip corpus %d cases, %d failures", COMPACT_CORPUS_RANDOM + 4, failures);
+
+    v2x_rsm_participant_t *set = mec_malloc(participants * sizeof(v2x_rsm_participant_t));
+    if (!set) return -1;
+    unsigned int seed = 7;
+    for (int i = 0; i < participants; i++) random_participant(&seed, &set[i]);
+
+    uint8_t buf[V2X_COMPACT_MAX_BYTES];
+    v2x_rsm_participant_t decoded[V2X_COMPACT_MAX_PARTICIPANTS];
+    struct timespec t0, t1, t2;
+    long bytes = 0, sink = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int r = 0; r < COMPACT_BENCH_ROUNDS; r++) {
+        for (int i = 0; i < participants; i += V2X_COMPACT_MAX_PARTICIPANTS) {
+            int count = participants - i;
+            if (count > V2X_COMPACT_MAX_PARTICIPANTS) count = V2X_COMPACT_MAX_PARTICIPANTS;
+            int len = v2x_compact_encode((uint8_t)r, 0xABCD, set + i, count, buf, sizeof(buf));
+            bytes += len;
+            sink += buf[len - 1];
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    for (int r = 0; r < COMPACT_BENCH_ROUNDS; r++) {
+        for (int i = 0; i < participants; i += V2X_COMPACT_MAX_PARTICIPANTS) {
+            int count = participants - i;
+            if (count > V2X_COMPACT_MAX_PARTICIPANTS) count = V2X_COMPACT_MAX_PARTICIPANTS;
+            int len = v2x_compact_encode((uint8_t)r, 0xABCD, set + i, count, buf, sizeof(buf));
+            sink += v2x_compact_decode(buf, len, NULL, NULL, decoded, V2X_COMPACT_MAX_PARTICIPANTS);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+
+    double encode_us = ((t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3) / COMPACT_BENCH_ROUNDS;
+    double roundtrip_us = ((t2.tv_sec - t1.tv_sec) * 1e6 + (t2.tv_nsec - t1.tv_nsec) / 1e3) / COMPACT_BENCH_ROUNDS;
+    LOG_INFO("Compact Bench: %d participants: encode %.2f us, decode %.2f us per snapshot, "
+             "%.1f bits/participant (checksum %ld)",
+             participants, encode_us, roundtrip_us - encode_us,
+             (double)bytes * 8 / ((double)participants * COMPACT_BENCH_ROUNDS), sink);
+
+    mec_free(set);
+    return failures == 0 ? 0 : -1;
+}
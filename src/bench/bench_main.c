@@ -0,0 +1,22 @@
+#include "bench.h"
+
+/**
+ * @file bench_main.c
+ * @brief mec_bench 入口：mec_bench <radar|v2x|udp|compact>
+ */
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <radar|v2x|udp|compact>\n", argv[0]);
+        return 2;
+    }
+
+    const char *bench = argv[1];
+    log_init(NULL, LOG_INFO);
+    if (strcmp(bench, "radar") == 0) return radar_polar_benchmark(1024) == 0 ? 0 : 1;
+    if (strcmp(bench, "v2x") == 0) return v2x_output_benchmark(1000) == 0 ? 0 : 1;
+    if (strcmp(bench, "udp") == 0) return v2x_udp_benchmark(200000) == 0 ? 0 : 1;
+    if (strcmp(bench, "compact") == 0) return v2x_compact_benchmark(500) == 0 ? 0 : 1;
+    LOG_ERROR("Unknown benchmark: %s (available: radar, v2x, udp, compact)", bench);
+    return 2;
+}
@@ -0,0 +1,140 @@
+#define _GNU_SOURCE  // SOCK_CLOEXEC
+#include "bench.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/**
+ * @file bench_udp.c
+ * @brief RSM UDP 发布回环基准：发送速率、丢包与逐包内容校验
+ */
+
+#define V2X_UDP_BENCH_BURST 16
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+typedef struct {
+    int fd;
+    volatile int running;
+    long received;
+    long corrupt;
+} udp_bench_receiver_t;
+
+// 回环接收端：逐包解析并校验目标内容
+static void* udp_bench_receive(void *arg) {
+    udp_bench_receiver_t *rx = (udp_bench_receiver_t*)arg;
+    v2x_rsm_participant_t participants[256];
+    uint8_t buf[V2X_MAX_PACKET];
+
+    while (rx->running) {
+        ssize_t n = recv(rx->fd, buf, sizeof(buf), 0);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) continue;
+            break;
+        }
+        int count = v2x_decode_rsm(buf, (int)n, NULL, participants, 256);
+        int ok = count > 0;
+        for (int i = 0; ok && i < count; i++) {
+            ok = participants[i].target_id == i + 1 &&
+                 participants[i].lat == (int32_t)((39.9087 + i * 1e-5) * 10000000.0);
+        }
+        if (ok) rx->received++;
+        else rx->corrupt++;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 回环发布基准（mec_bench udp）
+ *
+ * 本地接收端绑定 127.0.0.1 临时端口，发送 packets 个 RSM 报文（每批
+ * V2X_UDP_BENCH_BURST 个，一次 sendmmsg），接收端逐包解码校验内容。
+ * 输出发送速率、接收数、丢包与损坏计数。
+ */
+int v2x_udp_benchmark(int packets) {
+    udp_bench_receiver_t rx;
+    memset(&rx, 0, sizeof(rx));
+    rx.fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int rcvbuf = 8 << 20;
+    struct timeval timeout = {0, 100000};
+    if (rx.fd < 0 ||
+        setsockopt(rx.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) != 0 ||
+        setsockopt(rx.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0 ||
+        bind(rx.fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        getsockname(rx.fd, (struct sockaddr*)&addr, &addr_len) != 0) {
+        LOG_ERROR("UDP Bench: receiver setup failed: %s", strerror(errno));
+        if (rx.fd >= 0) close(rx.fd);
+        return -1;
+    }
+
+    v2x_udp_t *udp = mec_calloc(1, sizeof(v2x_udp_t));
+    v2x_output_config_t cfg = {0};
+    cfg.rsu_id = 0xABCD;
+    v2x_output_t *output = v2x_output_create(&cfg);
+    track_list_t *tracks = track_list_create(64);
+    pthread_t rx_thread;
+    rx.running = 1;
+    if (!udp || !output || !tracks || v2x_udp_add_dest(udp, "127.0.0.1", ntohs(addr.sin_port), 1, 0) != 0 ||
+        pthread_create(&rx_thread, NULL, udp_bench_receive, &rx) != 0) {
+        close(rx.fd);
+        v2x_udp_destroy(udp);
+        v2x_output_destroy(output);
+        track_list_release(tracks);
+        return -1;
+    }
+
+    target_track_t t;
+    memset(&t, 0, sizeof(t));
+    for (int i = 0; i < 64; i++) {
+        t.id = i + 1;
+        t.position.latitude = 39.9087 + i * 1e-5;
+        t.position.longitude = 116.3975 + i * 1e-5;
+        t.velocity = 10.0;
+        t.confidence = 0.9;
+        track_list_add(tracks, &t);
+    }
+
+    // 预先编码一整个环，发送阶段只计 sendmmsg
+    const v2x_packet_t *burst[V2X_UDP_BENCH_BURST];
+    const v2x_packet_t *fragments[V2X_MAX_FRAGMENTS];
+    for (int i = 0; i < V2X_UDP_BENCH_BURST; i++) {
+        v2x_output_encode(output, tracks, (uint64_t)i + 1, fragments);
+        burst[i] = fragments[0];
+    }
+
+    uint64_t t0 = monotonic_us();
+    int sent = 0;
+    while (sent < packets) {
+        int n = packets - sent < V2X_UDP_BENCH_BURST ? packets - sent : V2X_UDP_BENCH_BURST;
+        sent += n;
+        v2x_udp_send(udp, burst, n);
+        if (sent % (V2X_UDP_BENCH_BURST * 64) == 0) usleep(200);   // 给接收端留出排空时间
+    }
+    uint64_t t1 = monotonic_us();
+    usleep(200000);
+    rx.running = 0;
+    pthread_join(rx_thread, NULL);
+    close(rx.fd);
+
+    double seconds = (t1 - t0) / 1e6;
+    const v2x_dest_t *dest = &udp->dests[0];
+    LOG_INFO("UDP Bench: %d packets (%d B) in %.3f s: %.0f packets/s, %ld sendmmsg calls",
+             packets, burst[0]->len, seconds, seconds > 0 ? packets / seconds : 0.0, udp->batches);
+    LOG_INFO("UDP Bench: sent %ld, dropped %ld, received %ld, corrupt %ld",
+             dest->packets_sent, dest->packets_dropped, rx.received, rx.corrupt);
+
+    int ok = rx.corrupt == 0 && rx.received == dest->packets_sent && rx.received > 0;
+    v2x_udp_destroy(udp);
+    v2x_output_destroy(output);
+    track_list_release(tracks);
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,161 @@
+#include "bench.h"
+
+/**
+ * @file bench_v2x.c
+ * @brief V2X 输出级基准：全量与增量编码对比，增量快照解码重建校验
+ */
+
+#define V2X_BENCH_ROUNDS    2000
+#define V2X_BENCH_VERIFY    200
+#define V2X_ID_SPACE        65536
+
+// 基准场景：每 10 个目标中 1 个每轮移动，其余静止；每轮轮换一个目标缺席
+static void bench_scene(track_list_t *tracks, int targets, int round) {
+    target_track_t t;
+    memset(&t, 0, sizeof(t));
+    track_list_clear(tracks);
+    for (int i = 0; i < targets; i++) {
+        if (i == round % targets) continue;
+        t.id = i + 1;
+        t.type = (target_type_t)(i % 4);
+        t.position.latitude = 39.9087 + i * 1e-5 + (i % 10 == 0 ? round * 1e-6 : 0.0);
+        t.position.longitude = 116.3975 + i * 1e-5;
+        t.velocity = 10.0 + (i % 20);
+        t.heading = (i * 7) % 360;
+        t.confidence = 0.9;
+        track_list_add(tracks, &t);
+    }
+}
+
+// 基准接收端：按目标 ID 保存关键帧与最新增量（线上字节）
+typedef struct {
+    uint8_t key[V2X_ID_SPACE][V2X_PARTICIPANT_SIZE];
+    uint8_t delta[V2X_ID_SPACE][V2X_PARTICIPANT_SIZE];
+    uint32_t key_seq[V2X_ID_SPACE];
+    uint32_t delta_seq[V2X_ID_SPACE];
+    uint32_t expect_seq[V2X_ID_SPACE];
+    uint16_t key_ids[V2X_SNAPSHOT_MAX];
+    uint16_t delta_ids[V2X_SNAPSHOT_MAX];
+    int key_count;
+    int delta_count;
+    uint32_t keyframe_seq;
+} bench_receiver_t;
+
+/**
+ * @brief 解码一个快照的全部分片，以"关键帧 + 增量"重建目标集，
+ *        与当前航迹的量化结果逐字节比较
+ */
+static int bench_verify(bench_receiver_t *rx, const track_list_t *tracks,
+                        const v2x_packet_t *const *packets, int fragments) {
+    v2x_rsm_participant_t decoded[V2X_MAX_PACKET / V2X_PARTICIPANT_SIZE];
+    v2x_header_t header;
+    uint32_t seq = 0;
+    rx->delta_count = 0;
+
+    for (int f = 0; f < fragments; f++) {
+        int n = v2x_decode_rsm(packets[f]->data, packets[f]->len, &header, decoded,
+                               V2X_MAX_PACKET / V2X_PARTICIPANT_SIZE);
+        if (n < 0 || header.frag_index != f || header.frag_count != fragments) return -1;
+        int keyframe = header.flags & V2X_FLAG_KEYFRAME;
+        if (keyframe && f == 0) {
+            rx->keyframe_seq = header.seq;
+            rx->key_count = 0;
+        }
+        if (header.base_seq != rx->keyframe_seq) return -1;
+        seq = header.seq;
+
+        for (int i = 0; i < n; i++) {
+            uint16_t id = decoded[i].target_id;
+            if (keyframe) {
+                v2x_pack_participant(rx->key[id], &decoded[i]);
+                rx->key_seq[id] = seq;
+                rx->key_ids[rx->key_count++] = id;
+            } else {
+                v2x_pack_participant(rx->delta[id], &decoded[i]);
+                rx->delta_seq[id] = seq;
+                rx->delta_ids[rx->delta_count++] = id;
+            }
+        }
+    }
+
+    v2x_rsm_participant_t participant;
+    uint8_t expected[V2X_PARTICIPANT_SIZE];
+    for (int i = 0; i < tracks->count; i++) {
+        v2x_quantize_track(&tracks->tracks[i], &participant);
+        v2x_pack_participant(expected, &participant);
+        uint16_t id = participant.target_id;
+        rx->expect_seq[id] = seq;
+
+        const uint8_t *got = rx->delta_seq[id] == seq ? rx->delta[id] :
+                             rx->key_seq[id] == rx->keyframe_seq ? rx->key[id] : NULL;
+        if (!got || memcmp(got, expected, V2X_PARTICIPANT_SIZE) != 0) return -1;
+    }
+
+    // 重建结果中不得有多余目标：关键帧目标须在当前快照中或被删除，增量目标须在当前快照中
+    for (int k = 0; k < rx->key_count; k++) {
+        uint16_t id = rx->key_ids[k];
+        if (rx->expect_seq[id] != seq && !(rx->delta_seq[id] == seq && rx->delta[id][2] == V2X_TYPE_REMOVED)) {
+            return -1;
+        }
+    }
+    for (int k = 0; k < rx->delta_count; k++) {
+        uint16_t id = rx->delta_ids[k];
+        if (rx->delta[id][2] != V2X_TYPE_REMOVED && rx->expect_seq[id] != seq) return -1;
+    }
+    return 0;
+}
+
+static void bench_report(const char *mode, int targets, const v2x_output_t *output) {
+    double n = output->snapshots > 0 ? (double)output->snapshots : 1.0;
+    LOG_INFO("V2X Bench [%s]: %d targets x %ld snapshots: %.2f us/snapshot, %.0f B/snapshot, "
+             "%.1f fragments/snapshot, %ld truncated",
+             mode, targets, output->snapshots, output->encode_us / n, output->bytes / n,
+             output->fragments / n, output->truncated);
+}
+
+/**
+ * @brief 编码基准（mec_bench v2x）
+ *
+ * 同一组快照（约 10% 目标运动）分别以全量与增量模式编码，对比每快照耗时、
+ * 字节数与分片数；前 V2X_BENCH_VERIFY 个增量快照经解码重建后与原始航迹校验。
+ */
+int v2x_output_benchmark(int targets) {
+    if (targets <= 0 || targets >= V2X_ID_SPACE) return -1;
+
+    v2x_output_config_t cfg = {0};
+    cfg.rsu_id = 0xABCD;
+    v2x_output_t *full = v2x_output_create(&cfg);
+    cfg.delta = 1;
+    v2x_output_t *delta = v2x_output_create(&cfg);
+    track_list_t *tracks = track_list_create(targets);
+    bench_receiver_t *rx = mec_calloc(1, sizeof(bench_receiver_t));
+    if (!full || !delta || !tracks || !rx) {
+        v2x_output_destroy(full);
+        v2x_output_destroy(delta);
+        track_list_release(tracks);
+        mec_free(rx);
+        return -1;
+    }
+
+    const v2x_packet_t *packets[V2X_MAX_FRAGMENTS];
+    int mismatches = 0;
+    for (int r = 1; r <= V2X_BENCH_ROUNDS; r++) {
+        bench_scene(tracks, targets, r);
+        v2x_output_encode(full, tracks, (uint64_t)r, packets);
+        int fragments = v2x_output_encode(delta, tracks, (uint64_t)r, packets);
+        if (r <= V2X_BENCH_VERIFY && bench_verify(rx, tracks, packets, fragments) != 0) mismatches++;
+    }
+
+    bench_report("full", targets, full);
+    bench_report("delta", targets, delta);
+    LOG_INFO("V2X Bench: %d delta snapshots reconstructed, %d mismatches",
+             V2X_BENCH_VERIFY < V2X_BENCH_ROUNDS ? V2X_BENCH_VERIFY : V2X_BENCH_ROUNDS, mismatches);
+
+    int ok = mismatches == 0 && full->snapshots == V2X_BENCH_ROUNDS && delta->snapshots == V2X_BENCH_ROUNDS &&
+             full->truncated == 0 && delta->truncated == 0;
+    v2x_output_destroy(full);
+    v2x_output_destroy(delta);
+    track_list_release(tracks);
+    mec_free(rx);
+    return ok ? 0 : -1;
+}
@@ -1,7 +1,7 @@
 #include "mec_common.h"
 
 #define MAX_LINE_LENGTH 1024
-#define MAX_CONFIGS 100
+#define MAX_CONFIGS 512
 
 typedef struct config_entry {
     char key[128];
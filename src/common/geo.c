@@ -0,0 +1,165 @@
+#include "mec_geo.h"
+
+/**
+ * @file geo.c
+ * @brief 站点 ENU 坐标系与传感器安装位姿
+ *
+ * 以站点原点处的子午圈/卯酉圈曲率半径把 ENU 线性化为经纬度，
+ * 路口尺度（1 km 内）误差在厘米级。每个传感器的安装位姿（平移 + 偏航）
+ * 与该线性化在加载时合并为一个 2x3 仿射矩阵，运行时每个目标只需
+ * 若干次乘加，不做逐点的大地测量计算。
+ */
+
+#define WGS84_A   6378137.0
+#define WGS84_E2  6.69437999014e-3
+
+/**
+ * @brief 以 origin 为原点初始化站点坐标系
+ * @param origin 为 NULL 时退化为恒等映射（position 保留米制本地坐标）
+ */
+int geo_site_init(geo_site_t *site, const wgs84_coord_t *origin) {
+    if (!site) return -1;
+    memset(site, 0, sizeof(geo_site_t));
+    site->lat_per_north = site->lon_per_east = 1.0;
+    site->north_per_lat = site->east_per_lon = 1.0;
+    if (!origin) return 0;
+
+    if (origin->latitude < -89.0 || origin->latitude > 89.0) {
+        LOG_ERROR("Geo: Site latitude %.6f out of range", origin->latitude);
+        return -1;
+    }
+
+    double lat = origin->latitude * M_PI / 180.0;
+    double s = sin(lat);
+    double w = sqrt(1.0 - WGS84_E2 * s * s);
+    double meridian = WGS84_A * (1.0 - WGS84_E2) / (w * w * w); // 子午圈曲率半径 M
+    double normal = WGS84_A / w;                                // 卯酉圈曲率半径 N
+
+    site->origin = *origin;
+    site->valid = 1;
+    site->north_per_lat = M_PI * meridian / 180.0;
+    site->east_per_lon = M_PI * normal * cos(lat) / 180.0;
+    site->lat_per_north = 1.0 / site->north_per_lat;
+    site->lon_per_east = 1.0 / site->east_per_lon;
+    return 0;
+}
+
+/**
+ * @brief 从配置加载站点原点（site.origin_lat / origin_lon / origin_alt）
+ *
+ * 未配置或配置无效时为恒等映射。
+ */
+void geo_site_load(config_t *config, geo_site_t *site) {
+    if (config && config_get_string(config, "site.origin_lat", NULL) &&
+        config_get_string(config, "site.origin_lon", NULL)) {
+        wgs84_coord_t origin;
+        origin.latitude = config_get_double(config, "site.origin_lat", 0.0);
+        origin.longitude = config_get_double(config, "site.origin_lon", 0.0);
+        origin.altitude = config_get_double(config, "site.origin_alt", 0.0);
+        if (geo_site_init(site, &origin) == 0) {
+            LOG_DEBUG("Geo: Site origin %.7f, %.7f (%.1f m)", origin.latitude, origin.longitude, origin.altitude);
+            return;
+        }
+    }
+    geo_site_init(site, NULL);
+}
+
+/**
+ * @brief 由站点坐标系中的安装位置与偏航预计算传感器位姿
+ *
+ * 传感器坐标系：x 轴沿 yaw 方向（北起顺时针，度），y 轴为 x 轴逆时针 90°。
+ * yaw = 90 时传感器坐标系与 ENU 同向，即历史上直接把 x/y 当作东/北的约定。
+ */
+void geo_pose_init(geo_pose_t *pose, const geo_site_t *site, double east, double north, double yaw_deg) {
+    if (!pose || !site) return;
+
+    double yaw = yaw_deg * M_PI / 180.0;
+    double s = sin(yaw), c = cos(yaw);
+    pose->east = east;
+    pose->north = north;
+    pose->yaw = yaw_deg;
+    pose->altitude = site->origin.altitude;
+    pose->heading_offset = 90.0 - yaw_deg;
+
+    // e = x*sin(yaw) - y*cos(yaw) + east,  n = x*cos(yaw) + y*sin(yaw) + north
+    double *m = pose->enu;
+    m[0] = s;  m[1] = -c; m[2] = east;
+    m[3] = c;  m[4] = s;  m[5] = north;
+
+    // 与站点线性化合并：lat = lat0 + n * k_n，lon = lon0 + e * k_e
+    double *w = pose->wgs84;
+    w[0] = m[3] * site->lat_per_north;
+    w[1] = m[4] * site->lat_per_north;
+    w[2] = site->origin.latitude + m[5] * site->lat_per_north;
+    w[3] = m[0] * site->lon_per_east;
+    w[4] = m[1] * site->lon_per_east;
+    w[5] = site->origin.longitude + m[2] * site->lon_per_east;
+}
+
+/**
+ * @brief 从配置加载传感器位姿："<prefix>.pose.*"
+ *
+ * 安装位置可给站点 ENU 坐标（pose.east / pose.north，米），
+ * 也可给经纬度（pose.lat / pose.lon，需配置站点原点）；pose.yaw 默认 90。
+ */
+void geo_pose_load(config_t *config, const char *prefix, const geo_site_t *site, geo_pose_t *pose) {
+    char key[128];
+    double east, north;
+
+    snprintf(key, sizeof(key), "%s.pose.lat", prefix);
+    const char *lat = config_get_string(config, key, NULL);
+    snprintf(key, sizeof(key), "%s.pose.lon", prefix);
+    const char *lon = config_get_string(config, key, NULL);
+    if (lat && lon && site->valid) {
+        wgs84_coord_t mount;
+        mount.latitude = atof(lat);
+        mount.longitude = atof(lon);
+        geo_wgs84_to_enu(site, &mount, &east, &north);
+    } else {
+        if (lat || lon) LOG_WARN("Geo: %s.pose.lat/lon ignored without site origin", prefix);
+        snprintf(key, sizeof(key), "%s.pose.east", prefix);
+        east = config_get_double(config, key, 0.0);
+        snprintf(key, sizeof(key), "%s.pose.north", prefix);
+        north = config_get_double(config, key, 0.0);
+    }
+
+    snprintf(key, sizeof(key), "%s.pose.yaw", prefix);
+    geo_pose_init(pose, site, east, north, config_get_double(config, key, 90.0));
+    snprintf(key, sizeof(key), "%s.pose.alt", prefix);
+    pose->altitude = config_get_double(config, key, site->origin.altitude);
+}
+
+/**
+ * @brief 批量转换：传感器坐标系（position.longitude/latitude 为 x/y，米）-> WGS84
+ *
+ * 航向同时从传感器坐标系旋转到 ENU（东起逆时针，度）。
+ */
+void geo_tracks_sensor_to_wgs84(const geo_pose_t *pose, target_track_t *tracks, int count) {
+    const double *w = pose->wgs84;
+    for (int i = 0; i < count; i++) {
+        double x = tracks[i].position.longitude;
+        double y = tracks[i].position.latitude;
+        tracks[i].position.latitude = w[0] * x + w[1] * y + w[2];
+        tracks[i].position.longitude = w[3] * x + w[4] * y + w[5];
+        tracks[i].position.altitude = pose->altitude;
+        tracks[i].heading += pose->heading_offset;
+    }
+}
+
+// 批量转换：站点 ENU（position.longitude/latitude 为东/北，米）-> WGS84
+void geo_tracks_enu_to_wgs84(const geo_site_t *site, target_track_t *tracks, int count) {
+    for (int i = 0; i < count; i++) {
+        geo_enu_to_wgs84(site, tracks[i].position.longitude, tracks[i].position.latitude, &tracks[i].position);
+    }
+}
+
+// 批量转换：WGS84 -> 站点 ENU，结果写入 east/north 数组（SoA）
+void geo_tracks_wgs84_to_enu(const geo_site_t *site, const target_track_t *tracks, int count,
+                             double *east, double *north) {
+    double lat0 = site->origin.latitude, lon0 = site->origin.longitude;
+    double kn = site->north_per_lat, ke = site->east_per_lon;
+    for (int i = 0; i < count; i++) {
+        east[i] = (tracks[i].position.longitude - lon0) * ke;
+        north[i] = (tracks[i].position.latitude - lat0) * kn;
+    }
+}
@@ -84,20 +84,38 @@ void* monitor_server_thread(void *arg) {
 
         // 获取当前性能指标数据
         // 注意：这里我们直接生成一个简单的报文
-        char buffer[512];
+        char buffer[4096];
         
         // 此处需要获取 metrics。由于 metrics 是静态全局的，直接获取上一次的报文数据。
         // 为了演示，我们生成一个状态 JSON
         int active_tracks = (mon->config.fusion_proc) ? mon->config.fusion_proc->track_count : 0;
         
-        snprintf(buffer, sizeof(buffer), 
+        int len = snprintf(buffer, sizeof(buffer), 
             "{\n"
             "  \"status\": \"running\",\n"
             "  \"tracks\": %d,\n"
-            "  \"uptime_s\": %ld\n"
-            "}\n", 
+            "  \"uptime_s\": %ld,\n"
+            "  \"cameras\": [", 
             active_tracks, time(NULL)); // 实际项目中可加入更多 metrics 接口数据
 
+        // 每路相机的帧率 / 时延 / 丢帧 / 运动门控 / 负载调节状态
+        video_pool_t *pool = mon->config.video_pool;
+        for (int i = 0; pool && i < pool->camera_count && len < (int)sizeof(buffer); i++) {
+            video_camera_stats_t st;
+            video_govern_state_t gov;
+            video_processor_get_stats(pool->cameras[i], &st);
+            video_processor_get_govern(pool->cameras[i], &gov);
+            len += snprintf(buffer + len, sizeof(buffer) - len,
+                "%s\n    {\"id\": %d, \"fps\": %.2f, \"latency_ms\": %.2f, \"captured\": %ld, \"dropped\": %ld, "
+                "\"skipped\": %ld, \"cropped\": %ld, \"throttled\": %ld, \"fps_limit\": %.1f, \"scale\": %.2f}",
+                i ? "," : "", pool->cameras[i]->config.camera_id, st.fps, st.avg_latency_ms,
+                st.frames_captured, st.frames_dropped, st.frames_skipped, st.frames_cropped,
+                st.frames_throttled, gov.fps_limit, gov.scale);
+        }
+        if (len < (int)sizeof(buffer)) {
+            snprintf(buffer + len, sizeof(buffer) - len, "\n  ]\n}\n");
+        }
+
         send(client_fd, buffer, strlen(buffer), 0);
         close(client_fd);
     }
@@ -17,7 +17,7 @@ int thread_create(thread_context_t *ctx, void *(*start_routine)(void*), void *ar
         return -1;
     }
     
-    if (pthread_create(&ctx->thread, NULL, start_routine, ctx) != 0) {
+    if (pthread_create(&ctx->thread, NULL, start_routine, arg) != 0) {
         LOG_ERROR("Failed to create thread");
         pthread_mutex_destroy(&ctx->mutex);
         pthread_cond_destroy(&ctx->cond);
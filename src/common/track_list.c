@@ -1,11 +1,12 @@
 #include "mec_common.h"
 
-track_list_t* track_list_create(int initial_capacity) {
+static track_list_t* track_list_alloc(int initial_capacity, int pooled) {
     track_list_t *list = malloc(sizeof(track_list_t));
     if (!list) return NULL;
     
-    // 从高性能内存池分配航迹缓冲区
-    list->tracks = mec_malloc(initial_capacity * sizeof(target_track_t));
+    // 从高性能内存池分配航迹缓冲区（常驻的发布环列表直接走堆，不占池块）
+    size_t size = initial_capacity * sizeof(target_track_t);
+    list->tracks = pooled ? mec_malloc(size) : malloc(size);
     if (!list->tracks) {
         mec_free(list);
         return NULL;
@@ -19,6 +20,10 @@ track_list_t* track_list_create(int initial_capacity) {
     return list;
 }
 
+track_list_t* track_list_create(int initial_capacity) {
+    return track_list_alloc(initial_capacity, 1);
+}
+
 void track_list_retain(track_list_t *list) {
     if (!list) return;
     pthread_mutex_lock(&list->ref_lock);
@@ -67,3 +72,55 @@ void track_list_clear(track_list_t *list) {
         list->count = 0;
     }
 }
+
+/**
+ * @brief 初始化发布环：预先创建 TRACK_LIST_RING_SIZE 个列表
+ *
+ * 发布者每个周期取一个空闲列表填充后发布，读者释放后列表回到空闲，
+ * 稳态下不再分配。每个环只允许一个发布者调用 acquire。
+ * 创建失败的槽位在 acquire 时回退为普通分配。
+ */
+void track_list_ring_init(track_list_ring_t *ring, int capacity) {
+    if (!ring) return;
+    ring->next = 0;
+    ring->capacity = capacity > 0 ? capacity : 1;
+    for (int i = 0; i < TRACK_LIST_RING_SIZE; i++) ring->lists[i] = track_list_alloc(ring->capacity, 0);
+}
+
+// 释放环持有的引用；仍被读者持有的列表在其释放时销毁
+void track_list_ring_destroy(track_list_ring_t *ring) {
+    if (!ring) return;
+    for (int i = 0; i < TRACK_LIST_RING_SIZE; i++) {
+        track_list_release(ring->lists[i]);
+        ring->lists[i] = NULL;
+    }
+}
+
+/**
+ * @brief 取一个只被环引用的列表（引用计数为 1 即无人发布或读取），清空后返回
+ *
+ * 全部列表仍被持有时（读者处理过慢）回退为新建列表，发布逻辑不受影响。
+ */
+track_list_t* track_list_ring_acquire(track_list_ring_t *ring) {
+    if (!ring) return NULL;
+    for (int k = 0; k < TRACK_LIST_RING_SIZE; k++) {
+        int idx = (ring->next + k) % TRACK_LIST_RING_SIZE;
+        track_list_t *list = ring->lists[idx];
+        if (!list) continue;
+
+        int idle = 0;
+        pthread_mutex_lock(&list->ref_lock);
+        if (list->ref_count == 1) {
+            list->ref_count++;
+            idle = 1;
+        }
+        pthread_mutex_unlock(&list->ref_lock);
+
+        if (idle) {
+            list->count = 0;
+            ring->next = (idx + 1) % TRACK_LIST_RING_SIZE;
+            return list;
+        }
+    }
+    return track_list_alloc(ring->capacity, 0);
+}
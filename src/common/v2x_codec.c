@@ -1,66 +1,153 @@
 #include "mec_v2x.h"
-#include <arpa/inet.h>
 
 /**
  * @file v2x_codec.c
  * @brief V2X 协议编解码实现
  * 
- * 采用大端字节序 (Network Byte Order) 进行序列化，确保跨平台兼容性。
+ * 采用大端字节序 (Network Byte Order) 逐字节打包，与结构体布局、
+ * 缓冲区对齐无关，确保跨平台兼容性。
  */
 
+// 显式大端打包：按字节写入，不依赖结构体布局与缓冲区对齐
+static inline uint8_t* put_u8(uint8_t *p, uint8_t v) {
+    p[0] = v;
+    return p + 1;
+}
+
+static inline uint8_t* put_be16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+    return p + 2;
+}
+
+static inline uint8_t* put_be32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+    return p + 4;
+}
+
+static inline uint8_t* put_be64(uint8_t *p, uint64_t v) {
+    p = put_be32(p, (uint32_t)(v >> 32));
+    return put_be32(p, (uint32_t)v);
+}
+
+void v2x_encode_header(uint8_t *buf, const v2x_header_t *header) {
+    uint8_t *p = buf;
+    p = put_u8(p, 0x56); // 'V'
+    p = put_u8(p, V2X_PROTOCOL_VER);
+    p = put_u8(p, V2X_MSG_RSM);
+    p = put_be32(p, header->device_id);
+    p = put_be64(p, header->timestamp);
+    p = put_be32(p, header->seq);
+    p = put_be32(p, header->base_seq);
+    p = put_u8(p, header->frag_index);
+    p = put_u8(p, header->frag_count);
+    p = put_u8(p, header->flags);
+    put_be16(p, header->count);
+}
+
+// 量化为线上单位；负航向折算到 [0, 360)，速度取大小
+void v2x_quantize_track(const target_track_t *t, v2x_rsm_participant_t *out) {
+    double heading = fmod(t->heading, 360.0);
+    if (heading < 0.0) heading += 360.0;
+    double confidence = t->confidence < 0.0 ? 0.0 : (t->confidence > 1.0 ? 1.0 : t->confidence);
+
+    out->target_id = (uint16_t)t->id;
+    out->type = (uint8_t)t->type;
+    // 坐标转换为国标要求的 1e-7 度格式
+    out->lat = (int32_t)(t->position.latitude * 10000000.0);
+    out->lon = (int32_t)(t->position.longitude * 10000000.0);
+    // 速度转换 (单位: 0.02 m/s)
+    out->speed = (uint16_t)fmin(fabs(t->velocity) / 0.02, 65535.0);
+    // 航向转换 (单位: 0.0125 度)
+    out->heading = (uint16_t)(heading / 0.0125);
+    // 置信度转换 (0-200)
+    out->confidence = (uint8_t)(confidence * 200.0);
+}
+
+void v2x_pack_participant(uint8_t *buf, const v2x_rsm_participant_t *participant) {
+    uint8_t *p = buf;
+    p = put_be16(p, participant->target_id);
+    p = put_u8(p, participant->type);
+    p = put_be32(p, (uint32_t)participant->lat);
+    p = put_be32(p, (uint32_t)participant->lon);
+    p = put_be16(p, participant->speed);
+    p = put_be16(p, participant->heading);
+    put_u8(p, participant->confidence);
+}
+
 int v2x_encode_rsm(const track_list_t *tracks, uint32_t rsu_id, uint8_t *out_buf, int *out_len) {
     if (!tracks || !out_buf || !out_len) return -1;
 
-    int max_len = *out_len;
-    int current_pos = 0;
-
-    // 1. 填充头部 (Header)
-    if (max_len < (int)sizeof(v2x_header_t)) return -1;
-    
-    v2x_header_t *hdr = (v2x_header_t *)out_buf;
-    hdr->magic = 0x56; // 'V'
-    hdr->version = V2X_PROTOCOL_VER;
-    hdr->msg_type = V2X_MSG_RSM;
-    hdr->device_id = htonl(rsu_id);
-    
+    // 单包编码：放不下时报错，不截断（大目标数走 v2x_output_encode 分片）
+    int len = V2X_HEADER_SIZE + tracks->count * V2X_PARTICIPANT_SIZE;
+    if (tracks->count > 0xFFFF || len > *out_len) return -1;
+
     struct timeval tv;
     gettimeofday(&tv, NULL);
-    uint64_t ms = (uint64_t)tv.tv_sec * 1000 + (tv.tv_usec / 1000);
-    // 这里简单处理字节序，实际复杂场景建议使用专用 64位转换函数
-    memcpy(&hdr->timestamp, &ms, 8); 
-
-    current_pos += sizeof(v2x_header_t);
-
-    // 2. 写入目标数量
-    if (current_pos + 1 > max_len) return -1;
-    out_buf[current_pos++] = (uint8_t)tracks->count;
-
-    // 3. 序列化每一个目标
-    for (int i = 0; i < tracks->count; i++) {
-        if (current_pos + (int)sizeof(v2x_rsm_participant_t) > max_len) break;
-
-        const target_track_t *t = &tracks->tracks[i];
-        v2x_rsm_participant_t *p = (v2x_rsm_participant_t *)(out_buf + current_pos);
-
-        p->target_id = htons((uint16_t)t->id);
-        p->type = (uint8_t)t->type;
-        
-        // 坐标转换为国标要求的 1e-7 度格式
-        p->lat = htonl((int32_t)(t->position.latitude * 10000000.0));
-        p->lon = htonl((int32_t)(t->position.longitude * 10000000.0));
-        
-        // 速度转换 (单位: 0.02 m/s)
-        p->speed = htons((uint16_t)(t->velocity / 0.02));
-        
-        // 航向转换 (单位: 0.0125 度)
-        p->heading = htons((uint16_t)(t->heading / 0.0125));
-        
-        // 置信度转换 (0-200)
-        p->confidence = (uint8_t)(t->confidence * 200.0);
-
-        current_pos += sizeof(v2x_rsm_participant_t);
+
+    v2x_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.device_id = rsu_id;
+    header.timestamp = (uint64_t)tv.tv_sec * 1000 + (tv.tv_usec / 1000);
+    header.frag_count = 1;
+    header.flags = V2X_FLAG_KEYFRAME;
+    header.count = (uint16_t)tracks->count;
+    v2x_encode_header(out_buf, &header);
+
+    uint8_t *p = out_buf + V2X_HEADER_SIZE;
+    v2x_rsm_participant_t participant;
+    for (int i = 0; i < tracks->count; i++, p += V2X_PARTICIPANT_SIZE) {
+        v2x_quantize_track(&tracks->tracks[i], &participant);
+        v2x_pack_participant(p, &participant);
     }
 
-    *out_len = current_pos;
+    *out_len = len;
     return 0;
 }
+
+static inline uint16_t get_be16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t get_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+int v2x_decode_rsm(const uint8_t *buf, int len, v2x_header_t *header,
+                   v2x_rsm_participant_t *participants, int max_participants) {
+    if (!buf || len < V2X_HEADER_SIZE) return -1;
+    if (buf[0] != 0x56 || buf[1] != V2X_PROTOCOL_VER || buf[2] != V2X_MSG_RSM) return -1;
+
+    int count = get_be16(buf + 26);
+    if (len != V2X_HEADER_SIZE + count * V2X_PARTICIPANT_SIZE) return -1;
+    if (buf[24] == 0 || buf[23] >= buf[24]) return -1;   // 分片序号越界
+    if (header) {
+        header->magic = buf[0];
+        header->version = buf[1];
+        header->msg_type = buf[2];
+        header->device_id = get_be32(buf + 3);
+        header->timestamp = ((uint64_t)get_be32(buf + 7) << 32) | get_be32(buf + 11);
+        header->seq = get_be32(buf + 15);
+        header->base_seq = get_be32(buf + 19);
+        header->frag_index = buf[23];
+        header->frag_count = buf[24];
+        header->flags = buf[25];
+        header->count = (uint16_t)count;
+    }
+
+    const uint8_t *p = buf + V2X_HEADER_SIZE;
+    for (int i = 0; i < count && participants && i < max_participants; i++, p += V2X_PARTICIPANT_SIZE) {
+        v2x_rsm_participant_t *out = &participants[i];
+        out->target_id = get_be16(p);
+        out->type = p[2];
+        out->lat = (int32_t)get_be32(p + 3);
+        out->lon = (int32_t)get_be32(p + 7);
+        out->speed = get_be16(p + 11);
+        out->heading = get_be16(p + 13);
+        out->confidence = p[15];
+    }
+    return count;
+}
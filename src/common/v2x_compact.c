@@ -0,0 +1,223 @@
+#include "mec_v2x.h"
+#include <endian.h>
+#include <stddef.h>
+
+/**
+ * @file v2x_compact.c
+ * @brief 目标列表的紧凑私有位打包编码（表驱动）
+ *
+ * 这不是标准 RSM（GB/T 31024 / YD/T 3709 / J2735）的 UPER 编码：
+ * 只借用 UPER 的打包规则，消息结构与字段集合是本系统私有的（精简头部、
+ * 无 OPTIONAL 位图、附加 confidence 字段），标准 ASN.1 解码器无法解析。
+ * 仅供自有接收端、录制或带宽受限链路使用，当前不接入 v2x_output 发布。
+ *
+ * 字段由编译期字段表描述（结构体偏移、宽度、约束上下界），
+ * 位宽 ceil(log2(ub - lb + 1)) 在编译期求出；编码器与解码器遍历
+ * 同一张表，新增或调整字段只需改表。约束整数写入 (value - lb) 的
+ * 最少位数，可扩展枚举前置 1 位扩展标志，消息整体末尾补齐到字节。
+ *
+ * 写入器在 64 位累加器中攒位，每次写入后以一次 8 字节大端存储落盘
+ * 并只前移完整字节，逐字段无按位循环；读取器同样按 8 字节加载。
+ * 全部状态在栈上，不做堆分配。
+ */
+
+typedef enum {
+    FIELD_INT,       // 约束整数 (lb..ub)
+    FIELD_ENUM_EXT   // 可扩展枚举 { lb..ub, ... }：扩展位 + 根索引
+} field_kind_t;
+
+typedef struct {
+    uint16_t offset;     // 在 v2x_rsm_participant_t 中的偏移
+    uint8_t size;        // 成员宽度（1 / 2 / 4 字节）
+    uint8_t is_signed;
+    uint8_t kind;
+    uint8_t bits;        // 编译期求出的位宽
+    int64_t lb;
+    int64_t ub;
+} compact_field_t;
+
+#define FIELD_BITS(lb, ub) ((uint8_t)(64 - __builtin_clzll((uint64_t)((int64_t)(ub) - (int64_t)(lb)))))
+#define FIELD_MEMBER(m)    (((v2x_rsm_participant_t*)0)->m)
+#define COMPACT_FIELD(m, kind, lb, ub) \
+    { offsetof(v2x_rsm_participant_t, m), sizeof(FIELD_MEMBER(m)), \
+      (__typeof__(FIELD_MEMBER(m)))-1 < 0, kind, FIELD_BITS(lb, ub), lb, ub }
+
+// 目标字段（取值约束参照 YD/T 3709 / J2735 对应类型，便于与标准消息互转；confidence 为私有字段）
+static const compact_field_t participant_fields[] = {
+    COMPACT_FIELD(type,       FIELD_ENUM_EXT, 0, 4),                     // ptcType
+    COMPACT_FIELD(target_id,  FIELD_INT,      0, 65535),                 // ptcId
+    COMPACT_FIELD(lat,        FIELD_INT,      -900000000, 900000001),    // Latitude, 1e-7 度
+    COMPACT_FIELD(lon,        FIELD_INT,      -1799999999, 1800000001),  // Longitude, 1e-7 度
+    COMPACT_FIELD(speed,      FIELD_INT,      0, 8191),                  // Speed, 0.02 m/s
+    COMPACT_FIELD(heading,    FIELD_INT,      0, 28800),                 // Heading, 0.0125 度
+    COMPACT_FIELD(confidence, FIELD_INT,      0, 200),                   // 置信度, 0.5%
+};
+
+#define PARTICIPANT_FIELDS (int)(sizeof(participant_fields) / sizeof(participant_fields[0]))
+
+// 位写入器：acc 高位对齐保存未满一字节的尾部位，bits < 8
+typedef struct {
+    uint8_t *buf;
+    uint8_t *p;
+    uint8_t *end;
+    uint64_t acc;
+    int bits;
+    int overflow;
+} bit_writer_t;
+
+// 写入 value 的低 n 位（1 <= n <= 56）；溢出后的写入全部忽略
+static inline void bit_put(bit_writer_t *w, uint64_t value, int n) {
+    if (w->overflow) return;
+    w->acc |= value << (64 - w->bits - n);
+    w->bits += n;
+
+    if (w->end - w->p >= 8) {
+        uint64_t be = htobe64(w->acc);
+        memcpy(w->p, &be, 8);
+    } else {
+        // 缓冲区尾部：只写实际占用的字节
+        int need = (w->bits + 7) >> 3;
+        if (w->end - w->p < need) {
+            w->overflow = 1;
+            return;
+        }
+        for (int i = 0; i < need; i++) w->p[i] = (uint8_t)(w->acc >> (56 - 8 * i));
+    }
+
+    int bytes = w->bits >> 3;
+    w->p += bytes;
+    w->acc <<= bytes * 8;
+    w->bits &= 7;
+}
+
+static inline int bit_writer_len(const bit_writer_t *w) {
+    return (int)(w->p - w->buf) + (w->bits > 0);
+}
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;     // 位偏移
+} bit_reader_t;
+
+// 读取 n 位（1 <= n <= 57），越界返回 -1
+static inline int bit_get(bit_reader_t *r, int n, uint64_t *out) {
+    if (r->pos + n > r->len * 8) return -1;
+
+    size_t byte = r->pos >> 3;
+    uint64_t word;
+    if (byte + 8 <= r->len) {
+        memcpy(&word, r->buf + byte, 8);
+        word = be64toh(word);
+    } else {
+        word = 0;
+        for (size_t i = 0; byte + i < r->len; i++) word |= (uint64_t)r->buf[byte + i] << (56 - 8 * i);
+    }
+    *out = (word << (r->pos & 7)) >> (64 - n);
+    r->pos += n;
+    return 0;
+}
+
+static inline int64_t field_load(const compact_field_t *f, const v2x_rsm_participant_t *rec) {
+    const uint8_t *p = (const uint8_t*)rec + f->offset;
+    if (f->size == 1) return f->is_signed ? (int64_t)(int8_t)*p : (int64_t)*p;
+    if (f->size == 2) {
+        uint16_t v;
+        memcpy(&v, p, 2);
+        return f->is_signed ? (int64_t)(int16_t)v : (int64_t)v;
+    }
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return f->is_signed ? (int64_t)(int32_t)v : (int64_t)v;
+}
+
+static inline void field_store(const compact_field_t *f, v2x_rsm_participant_t *rec, int64_t value) {
+    uint8_t *p = (uint8_t*)rec + f->offset;
+    if (f->size == 1) {
+        *p = (uint8_t)value;
+    } else if (f->size == 2) {
+        uint16_t v = (uint16_t)value;
+        memcpy(p, &v, 2);
+    } else {
+        uint32_t v = (uint32_t)value;
+        memcpy(p, &v, 4);
+    }
+}
+
+// 超出约束的取值夹到边界（如速度超过 163.8 m/s），保证输出始终可解码
+static void encode_participant(bit_writer_t *w, const v2x_rsm_participant_t *participant) {
+    for (int i = 0; i < PARTICIPANT_FIELDS; i++) {
+        const compact_field_t *f = &participant_fields[i];
+        int64_t v = field_load(f, participant);
+        if (v < f->lb) v = f->lb;
+        if (v > f->ub) v = f->ub;
+        if (f->kind == FIELD_ENUM_EXT) bit_put(w, 0, 1);
+        bit_put(w, (uint64_t)(v - f->lb), f->bits);
+    }
+}
+
+static int decode_participant(bit_reader_t *r, v2x_rsm_participant_t *participant) {
+    uint64_t raw;
+    for (int i = 0; i < PARTICIPANT_FIELDS; i++) {
+        const compact_field_t *f = &participant_fields[i];
+        if (f->kind == FIELD_ENUM_EXT) {
+            if (bit_get(r, 1, &raw) != 0 || raw) return -1;   // 不支持扩展取值
+        }
+        if (bit_get(r, f->bits, &raw) != 0) return -1;
+        int64_t v = f->lb + (int64_t)raw;
+        if (v > f->ub) return -1;
+        field_store(f, participant, v);
+    }
+    return 0;
+}
+
+/**
+ * @brief 紧凑编码一组目标
+ *
+ * 消息结构（私有）：扩展位、msgCnt 7 位、64 位 id（高 32 位为 0，
+ * 低 32 位为 rsu_id）、目标数减一 4 位，其后逐个目标按字段表打包。
+ * @return 编码字节数，目标数越界或缓冲区不足返回 -1
+ */
+int v2x_compact_encode(uint8_t msg_cnt, uint32_t rsu_id, const v2x_rsm_participant_t *participants,
+                       int count, uint8_t *buf, int len) {
+    if (!participants || !buf || count < 1 || count > V2X_COMPACT_MAX_PARTICIPANTS) return -1;
+
+    bit_writer_t w = { buf, buf, buf + len, 0, 0, 0 };
+    bit_put(&w, 0, 1);
+    bit_put(&w, msg_cnt & 0x7F, 7);
+    bit_put(&w, 0, 32);
+    bit_put(&w, rsu_id, 32);
+    bit_put(&w, (uint64_t)(count - 1), 4);
+    for (int i = 0; i < count; i++) encode_participant(&w, &participants[i]);
+
+    return w.overflow ? -1 : bit_writer_len(&w);
+}
+
+/**
+ * @brief 解码 v2x_compact_encode 生成的报文
+ * @return 目标数，格式错误、截断或 max_participants 不足返回 -1
+ */
+int v2x_compact_decode(const uint8_t *buf, int len, uint8_t *msg_cnt, uint32_t *rsu_id,
+                       v2x_rsm_participant_t *participants, int max_participants) {
+    if (!buf || len <= 0 || !participants) return -1;
+
+    bit_reader_t r = { buf, (size_t)len, 0 };
+    uint64_t ext, cnt, id_high, id_low, count;
+    if (bit_get(&r, 1, &ext) != 0 || ext || bit_get(&r, 7, &cnt) != 0 ||
+        bit_get(&r, 32, &id_high) != 0 || bit_get(&r, 32, &id_low) != 0 ||
+        bit_get(&r, 4, &count) != 0) {
+        return -1;
+    }
+    count += 1;
+    if ((int)count > max_participants) return -1;
+
+    for (int i = 0; i < (int)count; i++) {
+        if (decode_participant(&r, &participants[i]) != 0) return -1;
+    }
+    // 剩余位只能是末字节补齐
+    if (r.len * 8 - r.pos >= 8) return -1;
+
+    if (msg_cnt) *msg_cnt = (uint8_t)cnt;
+    if (rsu_id) *rsu_id = (uint32_t)id_low;
+    return (int)count;
+}
@@ -0,0 +1,264 @@
+#include "mec_v2x.h"
+
+/**
+ * @file v2x_output.c
+ * @brief V2X 输出级：融合快照 -> RSM 报文环
+ *
+ * 输出线程等待融合引擎发布新版本的快照，每个版本只编码一次，
+ * 写入预分配的报文环（缓存行对齐，创建时一次性分配），编码过程为
+ * 对航迹列表的一次线性遍历，不做任何堆分配。环中保留最近
+ * V2X_OUTPUT_RING 个报文，供发送端在下一次编码期间继续引用。
+ * 配置了发布器时，编码完成的报文随即由本线程经 UDP 发出。
+ *
+ * 一个快照按 max_packet 拆分为若干分片（同一 seq，frag_index/frag_count
+ * 标明位置），目标数不再受单包容量限制；超出 V2X_MAX_FRAGMENTS 的目标
+ * 计入 truncated，不会产生错误的报文。
+ *
+ * 增量模式下每 keyframe_interval 个快照发送一个关键帧（全量），其余快照
+ * 只发送量化后与关键帧不同的目标、关键帧之后新出现的目标，以及关键帧中
+ * 已消失目标的删除记录（type = V2X_TYPE_REMOVED）。每个增量都只相对于
+ * base_seq 关键帧，接收端状态 = 关键帧 + 最新增量，丢失中间增量不累积误差。
+ */
+
+#define V2X_OUTPUT_WAIT_MS  100   // 等待新快照的超时，保证停止请求及时响应
+#define V2X_DEFAULT_PACKET  1400  // 以太网 MTU 内，避免 IP 分片
+#define V2X_DEFAULT_KEYFRAME_INTERVAL 10
+
+static double elapsed_us(const struct timespec *from, const struct timespec *to) {
+    return (to->tv_sec - from->tv_sec) * 1e6 + (to->tv_nsec - from->tv_nsec) / 1e3;
+}
+
+v2x_output_t* v2x_output_create(const v2x_output_config_t *config) {
+    if (!config) return NULL;
+
+    v2x_output_t *output = mec_calloc(1, sizeof(v2x_output_t));
+    if (!output) return NULL;
+    output->config = *config;
+    if (output->config.max_packet <= 0) output->config.max_packet = V2X_DEFAULT_PACKET;
+    if (output->config.max_packet > V2X_MAX_PACKET) output->config.max_packet = V2X_MAX_PACKET;
+    if (output->config.max_packet < V2X_HEADER_SIZE + V2X_PARTICIPANT_SIZE) {
+        output->config.max_packet = V2X_HEADER_SIZE + V2X_PARTICIPANT_SIZE;
+    }
+    if (output->config.keyframe_interval <= 0) output->config.keyframe_interval = V2X_DEFAULT_KEYFRAME_INTERVAL;
+
+    // 报文槽按缓存行对齐，不经过内存池
+    if (posix_memalign((void**)&output->ring, 64, V2X_OUTPUT_RING * sizeof(v2x_packet_t)) != 0) {
+        mec_free(output);
+        return NULL;
+    }
+    memset(output->ring, 0, V2X_OUTPUT_RING * sizeof(v2x_packet_t));
+
+    if (output->config.delta) {
+        output->keyframe = mec_calloc(V2X_KEYFRAME_SLOTS, sizeof(v2x_keyframe_slot_t));
+        output->keyframe_slots = mec_malloc(V2X_SNAPSHOT_MAX * sizeof(int));
+        if (!output->keyframe || !output->keyframe_slots) {
+            v2x_output_destroy(output);
+            return NULL;
+        }
+    }
+
+    LOG_INFO("V2X Output: RSU 0x%X, %d x %d B packet ring, %d B fragments, %s",
+             config->rsu_id, V2X_OUTPUT_RING, V2X_MAX_PACKET, output->config.max_packet,
+             output->config.delta ? "delta" : "full snapshots");
+    return output;
+}
+
+void v2x_output_destroy(v2x_output_t *output) {
+    if (!output) return;
+    v2x_output_stop(output);
+    free(output->ring);
+    mec_free(output->keyframe);
+    mec_free(output->keyframe_slots);
+    mec_free(output);
+}
+
+// 关键帧表按目标 ID 线性探测；返回该 ID 的槽位，不存在时返回可插入的空槽
+static v2x_keyframe_slot_t* keyframe_lookup(v2x_output_t *output, uint16_t id) {
+    uint32_t mask = V2X_KEYFRAME_SLOTS - 1;
+    for (uint32_t i = id & mask;; i = (i + 1) & mask) {
+        v2x_keyframe_slot_t *slot = &output->keyframe[i];
+        if (slot->gen != output->keyframe_gen || slot->id == id) return slot;
+    }
+}
+
+static void keyframe_begin(v2x_output_t *output) {
+    if (++output->keyframe_gen == 0) {   // 代号回绕：清空一次，避免旧槽位被误认
+        memset(output->keyframe, 0, V2X_KEYFRAME_SLOTS * sizeof(v2x_keyframe_slot_t));
+        output->keyframe_gen = 1;
+    }
+    output->keyframe_count = 0;
+}
+
+// 分片写入器：按顺序占用报文环中的槽位，每片最多 capacity 条记录
+typedef struct {
+    v2x_output_t *output;
+    v2x_packet_t *slots[V2X_MAX_FRAGMENTS];
+    int capacity;
+    int fragments;
+    int counts[V2X_MAX_FRAGMENTS];
+} fragment_writer_t;
+
+static uint8_t* fragment_next_record(fragment_writer_t *w) {
+    if (w->fragments == 0 || w->counts[w->fragments - 1] == w->capacity) {
+        if (w->fragments == V2X_MAX_FRAGMENTS) {
+            w->output->truncated++;
+            return NULL;
+        }
+        v2x_output_t *output = w->output;
+        w->slots[w->fragments] = &output->ring[(output->head + w->fragments) % V2X_OUTPUT_RING];
+        w->counts[w->fragments++] = 0;
+    }
+    int f = w->fragments - 1;
+    return w->slots[f]->data + V2X_HEADER_SIZE + (w->counts[f]++) * V2X_PARTICIPANT_SIZE;
+}
+
+/**
+ * @brief 将一个快照编码为报文环中连续的若干分片
+ *
+ * @param packets 输出分片指针，至少 V2X_MAX_FRAGMENTS 项（在环绕回这些槽位前保持有效）
+ * @return 分片数；版本号与上次相同时不重复编码，返回 0
+ */
+int v2x_output_encode(v2x_output_t *output, const track_list_t *tracks, uint64_t version,
+                      const v2x_packet_t **packets) {
+    if (!output || !tracks || !packets || version == output->last_version) return 0;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    output->last_version = version;
+
+    int delta = output->config.delta;
+    int keyframe = !delta || output->seq == 0 || output->since_keyframe >= output->config.keyframe_interval;
+    uint32_t seq = ++output->seq;
+    if (keyframe) {
+        output->keyframe_seq = seq;
+        output->since_keyframe = 0;
+        output->keyframes++;
+        if (delta) keyframe_begin(output);
+    } else {
+        output->since_keyframe++;
+    }
+
+    fragment_writer_t w;
+    w.output = output;
+    w.capacity = (output->config.max_packet - V2X_HEADER_SIZE) / V2X_PARTICIPANT_SIZE;
+    w.fragments = 0;
+
+    v2x_rsm_participant_t participant;
+    uint8_t packed[V2X_PARTICIPANT_SIZE];
+    for (int i = 0; i < tracks->count; i++) {
+        v2x_quantize_track(&tracks->tracks[i], &participant);
+        v2x_pack_participant(packed, &participant);
+
+        v2x_keyframe_slot_t *slot = delta ? keyframe_lookup(output, participant.target_id) : NULL;
+        if (slot && !keyframe && slot->gen == output->keyframe_gen) {
+            slot->seen_seq = seq;
+            if (memcmp(slot->packed, packed, V2X_PARTICIPANT_SIZE) == 0) continue;   // 与关键帧一致
+        }
+
+        uint8_t *record = fragment_next_record(&w);
+        if (!record) continue;
+        memcpy(record, packed, V2X_PARTICIPANT_SIZE);
+
+        if (slot && keyframe) {
+            if (slot->gen != output->keyframe_gen) {
+                slot->gen = output->keyframe_gen;
+                slot->id = participant.target_id;
+                output->keyframe_slots[output->keyframe_count++] = (int)(slot - output->keyframe);
+            }
+            memcpy(slot->packed, packed, V2X_PARTICIPANT_SIZE);
+        }
+    }
+
+    // 增量：关键帧中本快照未出现的目标发送删除记录
+    if (delta && !keyframe) {
+        for (int k = 0; k < output->keyframe_count; k++) {
+            v2x_keyframe_slot_t *slot = &output->keyframe[output->keyframe_slots[k]];
+            if (slot->seen_seq == seq) continue;
+            uint8_t *record = fragment_next_record(&w);
+            if (!record) continue;
+            memcpy(record, slot->packed, V2X_PARTICIPANT_SIZE);
+            record[2] = V2X_TYPE_REMOVED;
+        }
+    }
+
+    // 空快照也发送一个分片，接收端据此清空
+    if (w.fragments == 0) {
+        w.slots[0] = &output->ring[output->head % V2X_OUTPUT_RING];
+        w.counts[0] = 0;
+        w.fragments = 1;
+    }
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    v2x_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.device_id = output->config.rsu_id;
+    header.timestamp = (uint64_t)tv.tv_sec * 1000 + (tv.tv_usec / 1000);
+    header.seq = seq;
+    header.base_seq = output->keyframe_seq;
+    header.frag_count = (uint8_t)w.fragments;
+    header.flags = keyframe ? V2X_FLAG_KEYFRAME : V2X_FLAG_DELTA;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    uint64_t encoded_us = (uint64_t)t1.tv_sec * 1000000ULL + (uint64_t)t1.tv_nsec / 1000;
+    for (int f = 0; f < w.fragments; f++) {
+        v2x_packet_t *packet = w.slots[f];
+        header.frag_index = (uint8_t)f;
+        header.count = (uint16_t)w.counts[f];
+        v2x_encode_header(packet->data, &header);
+        packet->len = V2X_HEADER_SIZE + w.counts[f] * V2X_PARTICIPANT_SIZE;
+        packet->version = version;
+        packet->encoded_us = encoded_us;
+        output->bytes += packet->len;
+        packets[f] = packet;
+    }
+    output->head += w.fragments;
+
+    output->snapshots++;
+    output->fragments += w.fragments;
+    output->encode_us += elapsed_us(&t0, &t1);
+    return w.fragments;
+}
+
+static void* v2x_output_thread(void *arg) {
+    v2x_output_t *output = (v2x_output_t*)arg;
+
+    while (output->thread_ctx.running) {
+        uint64_t version;
+        track_list_t *tracks = fusion_processor_wait_tracks(output->config.fusion_proc, output->last_version,
+                                                            V2X_OUTPUT_WAIT_MS, &version);
+        if (!tracks) continue;
+
+        const v2x_packet_t *packets[V2X_MAX_FRAGMENTS];
+        int fragments = v2x_output_encode(output, tracks, version, packets);
+        if (fragments > 0) {
+            LOG_DEBUG("V2X: Encoded RSM v%llu (%d targets, %d fragments)",
+                      (unsigned long long)version, tracks->count, fragments);
+            v2x_udp_send(output->config.publisher, packets, fragments);
+        }
+        track_list_release(tracks);
+    }
+    return NULL;
+}
+
+int v2x_output_start(v2x_output_t *output) {
+    if (!output || !output->config.fusion_proc) return -1;
+    if (thread_create(&output->thread_ctx, v2x_output_thread, output) != 0) {
+        LOG_ERROR("V2X Output: Failed to start output thread");
+        output->thread_ctx.running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void v2x_output_stop(v2x_output_t *output) {
+    if (!output || !output->thread_ctx.running) return;
+    thread_destroy(&output->thread_ctx);
+}
+
+void v2x_output_report(v2x_output_t *output) {
+    if (!output) return;
+    LOG_INFO("V2X Output: %ld snapshots (%ld keyframes) in %ld fragments (%ld bytes, %.1f us avg), %ld truncated",
+             output->snapshots, output->keyframes, output->fragments, output->bytes,
+             output->snapshots > 0 ? output->encode_us / output->snapshots : 0.0, output->truncated);
+}
@@ -0,0 +1,175 @@
+#define _GNU_SOURCE  // sendmmsg / struct mmsghdr
+#include "mec_v2x.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+
+/**
+ * @file v2x_udp.c
+ * @brief RSM 报文 UDP 单播/组播发布
+ *
+ * 每个目的地址一个预先 connect 的非阻塞数据报套接字，发送时无需逐包
+ * 指定地址；一批报文（如一个快照的全部分片）以一次 sendmmsg 发出。
+ * 内核不接收的报文（发送缓冲区满等）直接计为丢弃，不重试：
+ * 过期的目标状态没有补发价值。
+ */
+
+#define V2X_UDP_BATCH       V2X_OUTPUT_RING
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 按配置创建发布器：v2x.dest.count 个目的地址 v2x.dest.<i> = "host:port"
+ *
+ * 组播地址使用 v2x.multicast_ttl / v2x.multicast_loop。
+ * @return 未配置目的地址时返回 NULL（只编码不发送）
+ */
+v2x_udp_t* v2x_udp_create(config_t *config) {
+    int count = config ? config_get_int(config, "v2x.dest.count", 0) : 0;
+    if (count <= 0) return NULL;
+    if (count > V2X_MAX_DESTS) {
+        LOG_WARN("V2X UDP: %d destinations configured, limiting to %d", count, V2X_MAX_DESTS);
+        count = V2X_MAX_DESTS;
+    }
+
+    v2x_udp_t *udp = mec_calloc(1, sizeof(v2x_udp_t));
+    if (!udp) return NULL;
+
+    int ttl = config_get_int(config, "v2x.multicast_ttl", 1);
+    int loop = config_get_int(config, "v2x.multicast_loop", 0);
+    for (int i = 0; i < count; i++) {
+        char key[64], host[64];
+        snprintf(key, sizeof(key), "v2x.dest.%d", i);
+        const char *dest = config_get_string(config, key, NULL);
+        const char *colon = dest ? strrchr(dest, ':') : NULL;
+        if (!colon || colon == dest || (size_t)(colon - dest) >= sizeof(host)) {
+            LOG_ERROR("V2X UDP: %s must be host:port", key);
+            v2x_udp_destroy(udp);
+            return NULL;
+        }
+        memcpy(host, dest, colon - dest);
+        host[colon - dest] = '\0';
+        if (v2x_udp_add_dest(udp, host, atoi(colon + 1), ttl, loop) != 0) {
+            v2x_udp_destroy(udp);
+            return NULL;
+        }
+    }
+    return udp;
+}
+
+void v2x_udp_destroy(v2x_udp_t *udp) {
+    if (!udp) return;
+    for (int i = 0; i < udp->dest_count; i++) {
+        if (udp->dests[i].socket_fd >= 0) close(udp->dests[i].socket_fd);
+    }
+    mec_free(udp);
+}
+
+int v2x_udp_add_dest(v2x_udp_t *udp, const char *host, int port, int ttl, int loop) {
+    if (!udp || !host || udp->dest_count >= V2X_MAX_DESTS || port <= 0 || port > 65535) return -1;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        LOG_ERROR("V2X UDP: Invalid IPv4 address %s", host);
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR("V2X UDP: socket failed: %s", strerror(errno));
+        return -1;
+    }
+
+    int multicast = IN_MULTICAST(ntohl(addr.sin_addr.s_addr));
+    if (multicast) {
+        unsigned char ttl_value = (unsigned char)ttl, loop_value = (unsigned char)(loop != 0);
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl_value, sizeof(ttl_value));
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop_value, sizeof(loop_value));
+    }
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        LOG_ERROR("V2X UDP: connect to %s:%d failed: %s", host, port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    v2x_dest_t *dest = &udp->dests[udp->dest_count++];
+    memset(dest, 0, sizeof(v2x_dest_t));
+    strncpy(dest->host, host, sizeof(dest->host) - 1);
+    dest->port = port;
+    dest->socket_fd = fd;
+    LOG_INFO("V2X UDP: Publishing RSM to %s:%d (%s)", host, port, multicast ? "multicast" : "unicast");
+    return 0;
+}
+
+/**
+ * @brief 将一批报文发送到全部目的地址，每个目的地址每批一次 sendmmsg
+ * @return 全部目的地址接收的报文总数
+ */
+int v2x_udp_send(v2x_udp_t *udp, const v2x_packet_t *const *packets, int count) {
+    if (!udp || !packets || count <= 0) return 0;
+
+    struct mmsghdr msgs[V2X_UDP_BATCH];
+    struct iovec iov[V2X_UDP_BATCH];
+    int total = 0;
+
+    for (int start = 0; start < count; start += V2X_UDP_BATCH) {
+        int n = count - start;
+        if (n > V2X_UDP_BATCH) n = V2X_UDP_BATCH;
+
+        memset(msgs, 0, n * sizeof(struct mmsghdr));
+        for (int i = 0; i < n; i++) {
+            iov[i].iov_base = (void*)packets[start + i]->data;
+            iov[i].iov_len = (size_t)packets[start + i]->len;
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        for (int d = 0; d < udp->dest_count; d++) {
+            v2x_dest_t *dest = &udp->dests[d];
+            int sent = 0;
+            while (sent < n) {
+                int r = sendmmsg(dest->socket_fd, msgs + sent, (unsigned int)(n - sent), 0);
+                if (r < 0) {
+                    if (errno == EINTR) continue;
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNREFUSED) {
+                        LOG_DEBUG("V2X UDP: send to %s:%d failed: %s", dest->host, dest->port, strerror(errno));
+                    }
+                    break;
+                }
+                sent += r;
+            }
+            dest->packets_sent += sent;
+            dest->packets_dropped += n - sent;
+            total += sent;
+            udp->batches++;
+        }
+
+        uint64_t now = monotonic_us();
+        for (int i = 0; i < n; i++) {
+            double latency = (double)(now - packets[start + i]->encoded_us);
+            udp->latency_us_total += latency;
+            if (latency > udp->latency_us_max) udp->latency_us_max = latency;
+            udp->latency_samples++;
+        }
+    }
+    return total;
+}
+
+void v2x_udp_report(v2x_udp_t *udp) {
+    if (!udp) return;
+    for (int d = 0; d < udp->dest_count; d++) {
+        const v2x_dest_t *dest = &udp->dests[d];
+        LOG_INFO("V2X UDP %s:%d: sent %ld, dropped %ld", dest->host, dest->port,
+                 dest->packets_sent, dest->packets_dropped);
+    }
+    LOG_INFO("V2X UDP: %ld batches, encode->send latency avg %.1f us, max %.1f us", udp->batches,
+             udp->latency_samples > 0 ? udp->latency_us_total / udp->latency_samples : 0.0, udp->latency_us_max);
+}
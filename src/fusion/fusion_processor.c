@@ -49,6 +49,7 @@ fusion_processor_t* fusion_processor_create(const fusion_config_t *config) {
     if (!processor) return NULL;
     
     processor->config = *config;
+    if (!config->site.valid) geo_site_init(&processor->config.site, NULL);
     processor->track_capacity = 100;
     processor->tracks = mec_calloc(processor->track_capacity, sizeof(fused_track_t));
     if (!processor->tracks) {
@@ -56,9 +57,41 @@ fusion_processor_t* fusion_processor_create(const fusion_config_t *config) {
         return NULL;
     }
     
+    processor->gate_soa = mec_malloc(4 * processor->track_capacity * sizeof(double));
+    processor->track_taken = mec_malloc(processor->track_capacity);
+    processor->candidate_capacity = 4 * processor->track_capacity;
+    processor->candidates = mec_malloc(processor->candidate_capacity * sizeof(fusion_candidate_t));
+    processor->meas_capacity = processor->track_capacity;
+    processor->meas_match = mec_malloc(processor->meas_capacity * sizeof(int));
+    processor->meas_enu = mec_malloc(2 * processor->meas_capacity * sizeof(double));
+    if (!processor->gate_soa || !processor->track_taken || !processor->candidates || !processor->meas_match ||
+        !processor->meas_enu) {
+        mec_free(processor->gate_soa);
+        mec_free(processor->track_taken);
+        mec_free(processor->candidates);
+        mec_free(processor->meas_match);
+        mec_free(processor->meas_enu);
+        mec_free(processor->tracks);
+        mec_free(processor);
+        return NULL;
+    }
+    
     processor->track_count = 0;
     processor->next_global_id = 1;
-    processor->output_tracks = track_list_create(processor->track_capacity);
+    track_list_ring_init(&processor->output_ring, processor->track_capacity);
+    processor->output_tracks = track_list_ring_acquire(&processor->output_ring);
+    processor->output_version = 0;
+    pthread_mutex_init(&processor->output_lock, NULL);
+    pthread_cond_init(&processor->output_cond, NULL);
+    processor->snapshot = NULL;
+    memset(processor->transition_cache, 0, sizeof(processor->transition_cache));
+    gettimeofday(&processor->last_snapshot, NULL);
+
+    // 快速重启：从内存映射快照热启动航迹库
+    if (config->snapshot_path[0] != '\0') {
+        processor->snapshot = fusion_snapshot_open(config->snapshot_path, processor->track_capacity);
+        fusion_snapshot_restore(processor->snapshot, processor);
+    }
     
     LOG_INFO("Fusion: Processor created (Assoc Threshold: %.2f)", config->association_threshold);
     return processor;
@@ -67,7 +100,19 @@ fusion_processor_t* fusion_processor_create(const fusion_config_t *config) {
 void fusion_processor_destroy(fusion_processor_t *processor) {
     if (!processor) return;
     fusion_processor_stop(processor);
+    if (processor->snapshot) {
+        fusion_snapshot_save(processor->snapshot, processor);
+        fusion_snapshot_close(processor->snapshot);
+    }
     track_list_release(processor->output_tracks);
+    track_list_ring_destroy(&processor->output_ring);
+    pthread_cond_destroy(&processor->output_cond);
+    pthread_mutex_destroy(&processor->output_lock);
+    mec_free(processor->gate_soa);
+    mec_free(processor->track_taken);
+    mec_free(processor->candidates);
+    mec_free(processor->meas_match);
+    mec_free(processor->meas_enu);
     mec_free(processor->tracks);
     mec_free(processor);
 }
@@ -120,43 +165,102 @@ int initialize_kalman_filter(kalman_state_t *state, const target_track_t *track)
 }
 
 /**
- * @brief 预测步 (Prediction)
- * X_k = F * X_{k-1}
- * P_k = F * P_{k-1} * F^T + Q
+ * @brief 构造给定 dt 的状态转移矩阵 F、F^T 与过程噪声
  */
-int predict_track_state(fused_track_t *track, double dt) {
-    if (!track || dt <= 0) return -1;
-    kalman_state_t *st = &track->filter_state;
-
-    // 1. 构造状态转移矩阵 F (6x6)
+static void build_transition(kalman_transition_t *kt, double dt) {
     // x = x + vx*dt + 0.5*ax*dt^2
-    double F[36] = {0};
-    for(int i=0; i<6; i++) F[i*6+i] = 1.0;
-    F[2] = dt; F[9] = dt; // vx, vy contributions to pos
-    F[4] = 0.5*dt*dt; F[11] = 0.5*dt*dt; // ax, ay to pos
-    F[16] = dt; F[23] = dt; // ax, ay to vel
+    memset(kt->F, 0, sizeof(kt->F));
+    for(int i=0; i<6; i++) kt->F[i*6+i] = 1.0;
+    kt->F[2] = dt; kt->F[9] = dt; // vx, vy contributions to pos
+    kt->F[4] = 0.5*dt*dt; kt->F[11] = 0.5*dt*dt; // ax, ay to pos
+    kt->F[16] = dt; kt->F[23] = dt; // ax, ay to vel
+    for(int i=0; i<6; i++) for(int j=0; j<6; j++) kt->FT[i*6+j] = kt->F[j*6+i];
+
+    // 过程噪声 Q (简化处理)
+    kt->q = 0.01 * dt;
+}
 
-    // 2. 预测状态 X = F * X
+/**
+ * @brief 应用状态转移
+ * X_k = F * X_{k-1}
+ * P_k = F * P_{k-1} * F^T + Q
+ */
+static void apply_transition(kalman_state_t *st, const kalman_transition_t *kt) {
     double next_x[6];
-    mat_mul(F, st->state, next_x, 6, 6, 1);
+    mat_mul(kt->F, st->state, next_x, 6, 6, 1);
     memcpy(st->state, next_x, sizeof(next_x));
 
-    // 3. 预测协方差 P = F * P * F^T + Q
     double FP[36], FPFt[36];
-    double FT[36];
-    for(int i=0; i<6; i++) for(int j=0; j<6; j++) FT[i*6+j] = F[j*6+i];
-    
-    mat_mul(F, st->covariance, FP, 6, 6, 6);
-    mat_mul(FP, FT, FPFt, 6, 6, 6);
-    
-    // 叠加过程噪声 Q (简化处理)
-    double Q_val = 0.01 * dt;
-    for(int i=0; i<36; i+=7) FPFt[i] += Q_val; 
+    mat_mul(kt->F, st->covariance, FP, 6, 6, 6);
+    mat_mul(FP, kt->FT, FPFt, 6, 6, 6);
+    for(int i=0; i<36; i+=7) FPFt[i] += kt->q;
 
     memcpy(st->covariance, FPFt, sizeof(st->covariance));
+}
+
+/**
+ * @brief 预测步 (Prediction)，按任意 dt 直接构造转移矩阵
+ */
+int predict_track_state(fused_track_t *track, double dt) {
+    if (!track || dt <= 0) return -1;
+
+    kalman_transition_t kt;
+    build_transition(&kt, dt);
+    apply_transition(&track->filter_state, &kt);
     return 0;
 }
 
+/**
+ * @brief 按量化 dt 查找转移矩阵缓存（直接映射，未命中时就地重建）
+ *
+ * 传感器周期固定，实际出现的 dt 只有少数几种，命中率接近 100%。
+ */
+static const kalman_transition_t* get_transition(fusion_processor_t *processor, int dt_ms) {
+    kalman_transition_t *kt = &processor->transition_cache[dt_ms % FUSION_TRANSITION_CACHE_SIZE];
+    if (kt->dt_ms != dt_ms) {
+        build_transition(kt, dt_ms * FUSION_DT_QUANTUM_MS / 1000.0);
+        kt->dt_ms = dt_ms;
+    }
+    return kt;
+}
+
+/**
+ * @brief 惰性预测：将航迹推进到指定时刻
+ *
+ * 仅在航迹参与门控/更新前调用；未被观测的航迹不做任何协方差运算。
+ * dt 量化到 FUSION_DT_QUANTUM_MS，状态时间按量化后的 dt 前移，避免累计漂移。
+ * @return 1:已推进, 0:无需推进（目标时刻不晚于当前状态时刻）, -1:参数错误
+ */
+int fusion_predict_to(fusion_processor_t *processor, fused_track_t *track, const struct timeval *when) {
+    if (!processor || !track || !when) return -1;
+    kalman_state_t *st = &track->filter_state;
+
+    long long dt_us = (long long)(when->tv_sec - st->last_update.tv_sec) * 1000000LL +
+                      (when->tv_usec - st->last_update.tv_usec);
+    int dt_q = (int)((dt_us + FUSION_DT_QUANTUM_MS * 500) / (FUSION_DT_QUANTUM_MS * 1000));
+    if (dt_q <= 0) return 0;
+
+    apply_transition(st, get_transition(processor, dt_q));
+
+    long long t_us = (long long)st->last_update.tv_usec + (long long)dt_q * FUSION_DT_QUANTUM_MS * 1000;
+    st->last_update.tv_sec += t_us / 1000000;
+    st->last_update.tv_usec = t_us % 1000000;
+    return 1;
+}
+
+/**
+ * @brief 仅外推状态均值（用于输出），不修改航迹、不传播协方差
+ */
+static void extrapolate_mean(const kalman_state_t *st, const struct timeval *when, double out[4]) {
+    double dt = (when->tv_sec - st->last_update.tv_sec) + (when->tv_usec - st->last_update.tv_usec) / 1000000.0;
+    if (dt < 0) dt = 0;
+    const double *x = st->state;
+    out[0] = x[0] + x[2] * dt + 0.5 * x[4] * dt * dt;
+    out[1] = x[1] + x[3] * dt + 0.5 * x[5] * dt * dt;
+    out[2] = x[2] + x[4] * dt;
+    out[3] = x[3] + x[5] * dt;
+}
+
 /**
  * @brief 更新步 (Update/Correction)
  * 使用马氏距离 (Mahalanobis Distance) 改进的更新逻辑
@@ -191,7 +295,7 @@ int update_kalman_filter(kalman_state_t *state, const target_track_t *meas) {
     double S_inv[4];
     if (mat_inv_2x2(S, S_inv) != 0) return -1;
 
-    double HTSinv[8]; // HT (6x2) * Sinv (2x2) = 6x2
+    double HTSinv[12]; // HT (6x2) * Sinv (2x2) = 6x2
     mat_mul(HT, S_inv, HTSinv, 6, 2, 2);
 
     double K[12]; // P (6x6) * HTSinv (6x2) = 6x2
@@ -246,42 +350,151 @@ double calculate_track_distance(const fused_track_t *track, const target_track_t
 
 /* --- 融合线程逻辑 (保持异步架构) --- */
 
-int fusion_processor_add_tracks(fusion_processor_t *processor, const track_list_t *tracks, int sensor_id) {
+static void create_fused_track(fusion_processor_t *processor, const target_track_t *s_track, int sensor_id) {
+    if (processor->track_count >= processor->track_capacity) return;
+
+    fused_track_t *new_t = &processor->tracks[processor->track_count++];
+    new_t->global_id = processor->next_global_id++;
+    new_t->type = s_track->type;
+    new_t->confidence = s_track->confidence;
+    new_t->age = 0;
+    new_t->sensor_mask = (1 << (sensor_id - 1));
+    new_t->last_update = s_track->timestamp;
+    initialize_kalman_filter(&new_t->filter_state, s_track);
+}
+
+static int compare_candidates(const void *a, const void *b) {
+    double da = ((const fusion_candidate_t *)a)->dist_sq;
+    double db = ((const fusion_candidate_t *)b)->dist_sq;
+    return (da > db) - (da < db);
+}
+
+static int push_candidate(fusion_processor_t *processor, int *count, int meas_idx, int track_idx, double dist_sq) {
+    if (*count >= processor->candidate_capacity) {
+        int new_capacity = processor->candidate_capacity * 2;
+        fusion_candidate_t *grown = mec_realloc(processor->candidates, new_capacity * sizeof(fusion_candidate_t));
+        if (!grown) return -1;
+        processor->candidates = grown;
+        processor->candidate_capacity = new_capacity;
+    }
+    fusion_candidate_t *c = &processor->candidates[(*count)++];
+    c->meas_idx = meas_idx;
+    c->track_idx = track_idx;
+    c->dist_sq = dist_sq;
+    return 0;
+}
+
+/**
+ * @brief 帧级融合：一次处理一整帧传感器扫描
+ *
+ * 1. 单次遍历航迹库：将所有航迹预测到扫描时刻，并把门控所需的
+ *    位置与方差倒数写入连续的 SoA 数组；
+ * 2. 每个量测在 SoA 数组上做紧凑的门控循环，收集候选配对；
+ * 3. 按距离全局排序后贪心分配（全局最近邻），保证一条航迹在同一帧内
+ *    最多被一个量测更新；
+ * 4. 未分配的量测创建新航迹。
+ *
+ * @param scan_time 扫描时间戳，整帧共享（为 NULL 时取当前时间）
+ */
+int fusion_processor_add_frame(fusion_processor_t *processor, const track_list_t *tracks,
+                               int sensor_id, const struct timeval *scan_time) {
     if (!processor || !tracks) return -1;
-    
+
+    struct timeval t_scan;
+    if (scan_time) t_scan = *scan_time;
+    else gettimeofday(&t_scan, NULL);
+
     thread_lock(&processor->thread_ctx);
-    for (int i = 0; i < tracks->count; i++) {
-        const target_track_t *s_track = &tracks->tracks[i];
-        
-        int best_idx = -1;
-        double min_dist = processor->config.association_threshold;
-        
-        for (int j = 0; j < processor->track_count; j++) {
-            double dist = calculate_track_distance(&processor->tracks[j], s_track);
-            if (dist < min_dist) {
-                min_dist = dist;
-                best_idx = j;
+
+    if (tracks->count > processor->meas_capacity) {
+        int *grown = mec_realloc(processor->meas_match, tracks->count * sizeof(int));
+        double *enu = grown ? mec_realloc(processor->meas_enu, 2 * tracks->count * sizeof(double)) : NULL;
+        if (grown) processor->meas_match = grown;
+        if (!enu) {
+            thread_unlock(&processor->thread_ctx);
+            return -1;
+        }
+        processor->meas_enu = enu;
+        processor->meas_capacity = tracks->count;
+    }
+
+    // 0. 量测由 WGS84 批量转换到站点 ENU（米），滤波与门控均在米制平面上进行
+    double *me = processor->meas_enu;
+    double *mn = me + processor->meas_capacity;
+    geo_tracks_wgs84_to_enu(&processor->config.site, tracks->tracks, tracks->count, me, mn);
+
+    // 1. 预测 + 构建门控数组
+    int n = processor->track_count;
+    double *gx = processor->gate_soa;
+    double *gy = gx + processor->track_capacity;
+    double *gix = gy + processor->track_capacity;
+    double *giy = gix + processor->track_capacity;
+    for (int j = 0; j < n; j++) {
+        fused_track_t *t = &processor->tracks[j];
+        fusion_predict_to(processor, t, &t_scan);
+        gx[j] = t->filter_state.state[0];
+        gy[j] = t->filter_state.state[1];
+        gix[j] = 1.0 / (t->filter_state.covariance[0] + 0.1); // 加上观测噪声
+        giy[j] = 1.0 / (t->filter_state.covariance[7] + 0.1);
+        processor->track_taken[j] = 0;
+    }
+
+    // 2. 门控；候选表扩容失败时本帧停止门控，未完成门控的量测不新建航迹
+    double gate_sq = processor->config.association_threshold * processor->config.association_threshold;
+    int cand_count = 0;
+    int gated = tracks->count;
+    for (int i = 0; i < tracks->count; i++) processor->meas_match[i] = -1;
+    for (int i = 0; i < gated; i++) {
+        double mx = me[i];
+        double my = mn[i];
+        for (int j = 0; j < n; j++) {
+            double dx = mx - gx[j];
+            double dy = my - gy[j];
+            double d2 = dx * dx * gix[j] + dy * dy * giy[j];
+            if (d2 < gate_sq && push_candidate(processor, &cand_count, i, j, d2) != 0) {
+                LOG_ERROR("Fusion: Candidate list allocation failed, gating stopped at %d/%d measurements",
+                          i, tracks->count);
+                gated = i;
+                break;
             }
         }
-        
-        if (best_idx >= 0) {
-            update_fused_track(&processor->tracks[best_idx], s_track);
-            processor->tracks[best_idx].sensor_mask |= (1 << (sensor_id - 1));
-        } else if (processor->track_count < processor->track_capacity) {
-            // 创建新航迹
-            fused_track_t *new_t = &processor->tracks[processor->track_count++];
-            new_t->global_id = processor->next_global_id++;
-            new_t->type = s_track->type;
-            new_t->confidence = s_track->confidence;
-            new_t->age = 0;
-            new_t->sensor_mask = (1 << (sensor_id - 1));
-            initialize_kalman_filter(&new_t->filter_state, s_track);
+    }
+
+    // 3. 全局最近邻分配
+    qsort(processor->candidates, cand_count, sizeof(fusion_candidate_t), compare_candidates);
+    for (int k = 0; k < cand_count; k++) {
+        const fusion_candidate_t *c = &processor->candidates[k];
+        if (processor->meas_match[c->meas_idx] >= 0 || processor->track_taken[c->track_idx]) continue;
+        processor->meas_match[c->meas_idx] = c->track_idx;
+        processor->track_taken[c->track_idx] = 1;
+    }
+
+    // 4. 更新与新建（整帧共享扫描时间戳，航迹状态时刻保持一致）
+    for (int i = 0; i < tracks->count; i++) {
+        target_track_t meas = tracks->tracks[i];
+        meas.position.longitude = me[i];
+        meas.position.latitude = mn[i];
+        meas.timestamp = t_scan;
+        int j = processor->meas_match[i];
+        if (j >= 0) {
+            update_fused_track(&processor->tracks[j], &meas);
+            processor->tracks[j].sensor_mask |= (1 << (sensor_id - 1));
+        } else if (i < gated) {
+            create_fused_track(processor, &meas, sensor_id);
         }
     }
+
     thread_unlock(&processor->thread_ctx);
     return 0;
 }
 
+int fusion_processor_add_tracks(fusion_processor_t *processor, const track_list_t *tracks, int sensor_id) {
+    if (!processor || !tracks) return -1;
+    // 兼容接口：以首个量测的时间戳作为整帧扫描时刻
+    return fusion_processor_add_frame(processor, tracks, sensor_id,
+                                      tracks->count > 0 ? &tracks->tracks[0].timestamp : NULL);
+}
+
 int update_fused_track(fused_track_t *fused_track, const target_track_t *sensor_track) {
     update_kalman_filter(&fused_track->filter_state, sensor_track);
     fused_track->confidence = 0.7 * fused_track->confidence + 0.3 * sensor_track->confidence;
@@ -290,19 +503,28 @@ int update_fused_track(fused_track_t *fused_track, const target_track_t *sensor_
     return 0;
 }
 
+// 替换输出快照并递增版本号，唤醒等待新快照的消费者
+static void publish_output(fusion_processor_t *proc, track_list_t *snapshot) {
+    pthread_mutex_lock(&proc->output_lock);
+    track_list_t *previous = proc->output_tracks;
+    proc->output_tracks = snapshot;
+    proc->output_version++;
+    pthread_cond_broadcast(&proc->output_cond);
+    pthread_mutex_unlock(&proc->output_lock);
+    track_list_release(previous);
+}
+
 void* fusion_processing_thread(void *arg) {
     fusion_processor_t *proc = (fusion_processor_t*)arg;
     while (proc->thread_ctx.running) {
         thread_lock(&proc->thread_ctx);
         struct timeval now;
         gettimeofday(&now, NULL);
-        
-        track_list_clear(proc->output_tracks);
+
+        // 每个周期填充一个空闲的输出快照，发布后不再修改（消费者持有引用即可安全读取）
+        track_list_t *snapshot = track_list_ring_acquire(&proc->output_ring);
         for (int i = 0; i < proc->track_count; i++) {
             fused_track_t *t = &proc->tracks[i];
-            double dt = (now.tv_sec - t->last_update.tv_sec) + (now.tv_usec - t->last_update.tv_usec)/1000000.0;
-            
-            predict_track_state(t, dt);
             t->age++;
 
             // 航迹管理：超时或置信度过低则删除
@@ -312,24 +534,79 @@ void* fusion_processing_thread(void *arg) {
                 continue;
             }
 
-            // 转换输出格式
+            // 转换输出格式（惰性预测：仅外推均值，协方差留到下次门控时再传播）
+            double est[4];
+            extrapolate_mean(&t->filter_state, &now, est);
+
             target_track_t out;
+            memset(&out, 0, sizeof(out));
             out.id = t->global_id;
             out.type = t->type;
-            out.position.longitude = t->filter_state.state[0];
-            out.position.latitude = t->filter_state.state[1];
-            out.velocity = sqrt(t->filter_state.state[2]*t->filter_state.state[2] + t->filter_state.state[3]*t->filter_state.state[3]);
-            out.heading = atan2(t->filter_state.state[3], t->filter_state.state[2]) * 180.0 / M_PI;
+            geo_enu_to_wgs84(&proc->config.site, est[0], est[1], &out.position);
+            out.velocity = sqrt(est[2]*est[2] + est[3]*est[3]);
+            out.heading = atan2(est[3], est[2]) * 180.0 / M_PI;
             out.confidence = t->confidence;
             out.timestamp = now;
-            track_list_add(proc->output_tracks, &out);
+            if (snapshot) track_list_add(snapshot, &out);
+        }
+        if (snapshot) publish_output(proc, snapshot);
+
+        // 周期性检查点（仅拷贝变化的记录，开销在微秒级）
+        if (proc->snapshot) {
+            long since_ms = (now.tv_sec - proc->last_snapshot.tv_sec) * 1000 +
+                            (now.tv_usec - proc->last_snapshot.tv_usec) / 1000;
+            if (since_ms >= proc->config.snapshot_interval_ms) {
+                fusion_snapshot_save(proc->snapshot, proc);
+                proc->last_snapshot = now;
+            }
         }
         thread_unlock(&proc->thread_ctx);
-        usleep(50000); // 20Hz 融合频率
+        usleep(FUSION_TICK_MS * 1000); // 20Hz 融合频率
     }
     return NULL;
 }
 
-track_list_t* fusion_processor_get_tracks(fusion_processor_t *processor) {
-    return (processor) ? processor->output_tracks : NULL;
+/**
+ * @brief 获取最新的融合输出快照（已增加引用，用完需 track_list_release）
+ * @param version 可为 NULL；输出快照版本号（每个融合周期递增）
+ */
+track_list_t* fusion_processor_acquire_tracks(fusion_processor_t *processor, uint64_t *version) {
+    if (!processor) return NULL;
+    pthread_mutex_lock(&processor->output_lock);
+    track_list_t *tracks = processor->output_tracks;
+    track_list_retain(tracks);
+    if (version) *version = processor->output_version;
+    pthread_mutex_unlock(&processor->output_lock);
+    return tracks;
+}
+
+/**
+ * @brief 等待版本号大于 after 的输出快照
+ * @return 新快照（已增加引用），超时返回 NULL
+ */
+track_list_t* fusion_processor_wait_tracks(fusion_processor_t *processor, uint64_t after, int timeout_ms,
+                                           uint64_t *version) {
+    if (!processor) return NULL;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&processor->output_lock);
+    while (processor->output_version <= after) {
+        if (pthread_cond_timedwait(&processor->output_cond, &processor->output_lock, &deadline) == ETIMEDOUT) break;
+    }
+    track_list_t *tracks = NULL;
+    if (processor->output_version > after) {
+        tracks = processor->output_tracks;
+        track_list_retain(tracks);
+        if (version) *version = processor->output_version;
+    }
+    pthread_mutex_unlock(&processor->output_lock);
+    return tracks;
 }
@@ -0,0 +1,228 @@
+#include "mec_fusion.h"
+#include <stddef.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @file fusion_snapshot.c
+ * @brief 融合航迹库的内存映射快照（快速重启）
+ *
+ * 文件布局：[文件头] [槽位 A] [槽位 B]
+ * 每次保存写入“非当前”槽位，写完后才更新该槽位的序号与校验和；
+ * 恢复时选择校验通过且序号最大的槽位。进程在写入中途崩溃时，
+ * 另一个槽位仍然完整可用，因此快照始终是崩溃一致的。
+ *
+ * 增量写入：槽位中与当前航迹逐字节相同的记录不会被重写，
+ * 静止/滑行航迹不会弄脏页面，msync 只需刷回真正变化的部分。
+ */
+
+#define SNAPSHOT_MAGIC   0x5343454DU  // "MECS"
+#define SNAPSHOT_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;   // sizeof(fused_track_t)，结构体变化时快照自动失效
+    uint32_t capacity;      // 每个槽位可容纳的航迹数
+} snapshot_file_header_t;
+
+typedef struct {
+    uint64_t seq;           // 提交序号，0 表示槽位从未写入
+    int64_t  wall_time_us;  // 快照时刻（墙上时钟，微秒）
+    int32_t  count;
+    int32_t  next_global_id;
+    uint32_t checksum;      // 覆盖本结构体前面字段与 count 条记录
+    uint32_t reserved;
+} snapshot_slot_header_t;
+
+struct fusion_snapshot_t {
+    int fd;
+    uint8_t *base;
+    size_t map_size;
+    size_t slot_size;
+    int capacity;
+    uint64_t seq;           // 最近一次提交的序号
+    int active_slot;        // 最近一次提交所在的槽位
+};
+
+static size_t page_align(size_t size) {
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0) page = 4096;
+    return (size + (size_t)page - 1) & ~((size_t)page - 1);
+}
+
+static snapshot_slot_header_t* slot_header(fusion_snapshot_t *snap, int slot) {
+    return (snapshot_slot_header_t *)(snap->base + page_align(sizeof(snapshot_file_header_t)) + slot * snap->slot_size);
+}
+
+static fused_track_t* slot_records(fusion_snapshot_t *snap, int slot) {
+    return (fused_track_t *)((uint8_t *)slot_header(snap, slot) + sizeof(snapshot_slot_header_t));
+}
+
+// FNV-1a，足够检测撕裂写入，且每字节只需一次乘法
+static uint32_t snapshot_checksum(const snapshot_slot_header_t *hdr, const fused_track_t *records) {
+    uint32_t h = 2166136261U;
+    const uint8_t *p = (const uint8_t *)hdr;
+    for (size_t i = 0; i < offsetof(snapshot_slot_header_t, checksum); i++) {
+        h = (h ^ p[i]) * 16777619U;
+    }
+    p = (const uint8_t *)records;
+    size_t len = (size_t)hdr->count * sizeof(fused_track_t);
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 16777619U;
+    }
+    return h;
+}
+
+static int slot_valid(fusion_snapshot_t *snap, int slot) {
+    snapshot_slot_header_t *hdr = slot_header(snap, slot);
+    if (hdr->seq == 0 || hdr->count < 0 || hdr->count > snap->capacity) return 0;
+    return snapshot_checksum(hdr, slot_records(snap, slot)) == hdr->checksum;
+}
+
+fusion_snapshot_t* fusion_snapshot_open(const char *path, int capacity) {
+    if (!path || path[0] == '\0' || capacity <= 0) return NULL;
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Snapshot: Failed to open %s (%s)", path, strerror(errno));
+        return NULL;
+    }
+
+    size_t slot_size = page_align(sizeof(snapshot_slot_header_t) + (size_t)capacity * sizeof(fused_track_t));
+    size_t map_size = page_align(sizeof(snapshot_file_header_t)) + 2 * slot_size;
+
+    // 文件尺寸或布局不匹配时重新初始化
+    struct stat st;
+    int reinit = (fstat(fd, &st) != 0 || (size_t)st.st_size != map_size);
+    if (reinit && (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)map_size) != 0)) {
+        LOG_ERROR("Snapshot: Failed to size %s (%s)", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    void *base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("Snapshot: mmap failed for %s (%s)", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    fusion_snapshot_t *snap = mec_calloc(1, sizeof(fusion_snapshot_t));
+    if (!snap) {
+        munmap(base, map_size);
+        close(fd);
+        return NULL;
+    }
+    snap->fd = fd;
+    snap->base = base;
+    snap->map_size = map_size;
+    snap->slot_size = slot_size;
+    snap->capacity = capacity;
+    snap->active_slot = 1;
+
+    snapshot_file_header_t *fh = (snapshot_file_header_t *)base;
+    if (reinit || fh->magic != SNAPSHOT_MAGIC || fh->version != SNAPSHOT_VERSION ||
+        fh->record_size != sizeof(fused_track_t) || fh->capacity != (uint32_t)capacity) {
+        memset(base, 0, map_size);
+        fh->magic = SNAPSHOT_MAGIC;
+        fh->version = SNAPSHOT_VERSION;
+        fh->record_size = sizeof(fused_track_t);
+        fh->capacity = (uint32_t)capacity;
+        msync(base, map_size, MS_ASYNC);
+        LOG_INFO("Snapshot: Initialized %s (%zu bytes)", path, map_size);
+    } else {
+        for (int slot = 0; slot < 2; slot++) {
+            if (slot_valid(snap, slot) && slot_header(snap, slot)->seq > snap->seq) {
+                snap->seq = slot_header(snap, slot)->seq;
+                snap->active_slot = slot;
+            }
+        }
+    }
+
+    return snap;
+}
+
+void fusion_snapshot_close(fusion_snapshot_t *snap) {
+    if (!snap) return;
+    msync(snap->base, snap->map_size, MS_SYNC);
+    munmap(snap->base, snap->map_size);
+    close(snap->fd);
+    mec_free(snap);
+}
+
+/**
+ * @brief 保存快照（调用方需持有融合处理器锁）
+ */
+int fusion_snapshot_save(fusion_snapshot_t *snap, const fusion_processor_t *processor) {
+    if (!snap || !processor) return -1;
+
+    int slot = 1 - snap->active_slot;
+    int count = processor->track_count < snap->capacity ? processor->track_count : snap->capacity;
+    snapshot_slot_header_t *hdr = slot_header(snap, slot);
+    fused_track_t *records = slot_records(snap, slot);
+
+    // 1. 先使该槽位失效，崩溃时恢复逻辑会回退到另一个槽位
+    hdr->seq = 0;
+
+    // 2. 增量写入：仅覆盖发生变化的记录
+    for (int i = 0; i < count; i++) {
+        if (memcmp(&records[i], &processor->tracks[i], sizeof(fused_track_t)) != 0) {
+            records[i] = processor->tracks[i];
+        }
+    }
+
+    // 3. 提交：写入元数据与校验和
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    hdr->wall_time_us = (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+    hdr->count = count;
+    hdr->next_global_id = processor->next_global_id;
+    hdr->seq = snap->seq + 1;
+    hdr->checksum = snapshot_checksum(hdr, records);
+
+    msync(hdr, snap->slot_size, MS_ASYNC);
+
+    snap->seq = hdr->seq;
+    snap->active_slot = slot;
+    return 0;
+}
+
+/**
+ * @brief 从快照热启动（在融合线程启动前调用）
+ *
+ * 根据快照时间戳计算停机期间错过的融合周期数，叠加到航迹年龄上，
+ * 超过 max_track_age 的陈旧航迹直接丢弃。
+ * @return 恢复的航迹数量，无有效快照时返回 -1
+ */
+int fusion_snapshot_restore(fusion_snapshot_t *snap, fusion_processor_t *processor) {
+    if (!snap || !processor || snap->seq == 0) return -1;
+
+    snapshot_slot_header_t *hdr = slot_header(snap, snap->active_slot);
+    fused_track_t *records = slot_records(snap, snap->active_slot);
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    int64_t now_us = (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+    int64_t elapsed_us = now_us - hdr->wall_time_us;
+    if (elapsed_us < 0) elapsed_us = 0;
+    int64_t missed_ticks = elapsed_us / (FUSION_TICK_MS * 1000);
+
+    int restored = 0;
+    for (int i = 0; i < hdr->count && restored < processor->track_capacity; i++) {
+        if (records[i].age + missed_ticks > processor->config.max_track_age) continue;
+        processor->tracks[restored] = records[i];
+        processor->tracks[restored].age += (int)missed_ticks;
+        restored++;
+    }
+    processor->track_count = restored;
+    if (hdr->next_global_id > processor->next_global_id) {
+        processor->next_global_id = hdr->next_global_id;
+    }
+
+    LOG_INFO("Snapshot: Restored %d/%d tracks (seq %llu, %.1f s old, next id %d)",
+             restored, hdr->count, (unsigned long long)hdr->seq,
+             elapsed_us / 1000000.0, processor->next_global_id);
+    return restored;
+}
@@ -66,6 +66,15 @@ int main(int argc, char *argv[]) {
         fusion_cfg.velocity_weight = config_get_double(config, "fusion.velocity_weight", 0.1);
         fusion_cfg.confidence_threshold = config_get_double(config, "fusion.confidence_threshold", 0.3);
         fusion_cfg.max_track_age = config_get_int(config, "fusion.max_track_age", 50);
+        strncpy(fusion_cfg.snapshot_path, config_get_string(config, "fusion.snapshot_path", ""), sizeof(fusion_cfg.snapshot_path) - 1);
+        fusion_cfg.snapshot_interval_ms = config_get_int(config, "fusion.snapshot_interval_ms", 200);
+        geo_site_load(config, &fusion_cfg.site);
+        if (fusion_cfg.site.valid) {
+            LOG_INFO("Site origin: %.7f, %.7f (positions in WGS84 degrees)",
+                     fusion_cfg.site.origin.latitude, fusion_cfg.site.origin.longitude);
+        } else {
+            LOG_WARN("Site origin not configured, positions stay in local metres");
+        }
     } else {
         fusion_cfg.association_threshold = 5.0;
         fusion_cfg.confidence_threshold = 0.3;
@@ -73,9 +82,12 @@ int main(int argc, char *argv[]) {
     }
 
     fusion_processor_t *fusion_proc = fusion_processor_create(&fusion_cfg);
-    video_processor_t *video_proc = NULL;
-    radar_processor_t *radar_proc = NULL;
+    video_pool_t *video_pool = NULL;
+    radar_io_t *radar_io = NULL;
     mec_simulator_t *simulator = NULL;
+    v2x_output_t *v2x_output = NULL;
+    v2x_udp_t *v2x_udp = NULL;
+    mec_monitor_t *monitor_service = NULL;
 
     // 6. 启动数据源（模拟器或真实传感器）
     if (sim_mode) {
@@ -94,20 +106,13 @@ int main(int argc, char *argv[]) {
         }
     } else {
         // 真实传感器模式：将队列句柄传入配置，实现生产者模式
-        video_config_t video_cfg = {0};
-        strncpy(video_cfg.rtsp_url, config_get_string(config, "video.rtsp_url", "rtsp://192.168.1.100:554/stream"), sizeof(video_cfg.rtsp_url) - 1);
-        video_cfg.camera_id = 1;
-        video_cfg.target_queue = msg_queue; // 绑定异步队列
-        
-        radar_config_t radar_cfg = {0};
-        strncpy(radar_cfg.device_path, config_get_string(config, "radar.device_path", "/dev/ttyUSB0"), sizeof(radar_cfg.device_path) - 1);
-        radar_cfg.radar_id = 2;
-        radar_cfg.target_queue = msg_queue; // 绑定异步队列
+        // 相机池按配置加载 N 路相机（video.camera_count / video.<i>.*）
+        video_pool = video_pool_create(config, msg_queue);
         
-        video_proc = video_processor_create(&video_cfg);
-        radar_proc = radar_processor_create(&radar_cfg);
+        // 全部雷达由一个 epoll I/O 线程驱动（radar.count / radar.<i>.*）
+        radar_io = radar_io_create(config, msg_queue);
         
-        if (video_processor_start(video_proc) != 0 || radar_processor_start(radar_proc) != 0) {
+        if (video_pool_start(video_pool) != 0 || radar_io_start(radar_io) != 0) {
             LOG_ERROR("Failed to start sensor threads");
             goto cleanup;
         }
@@ -119,11 +124,28 @@ int main(int argc, char *argv[]) {
         goto cleanup;
     }
 
+    // V2X 输出级：每个新的融合快照编码一次 RSM
+    v2x_output_config_t v2x_cfg = {0};
+    v2x_cfg.rsu_id = (uint32_t)(config ? config_get_int(config, "v2x.rsu_id", 0xABCD) : 0xABCD);
+    v2x_cfg.fusion_proc = fusion_proc;
+    v2x_cfg.publisher = v2x_udp = v2x_udp_create(config);
+    if (config) {
+        v2x_cfg.max_packet = config_get_int(config, "v2x.max_packet", 1400);
+        v2x_cfg.delta = config_get_int(config, "v2x.delta", 0);
+        v2x_cfg.keyframe_interval = config_get_int(config, "v2x.keyframe_interval", 10);
+    }
+    v2x_output = v2x_output_create(&v2x_cfg);
+    if (!v2x_output || v2x_output_start(v2x_output) != 0) {
+        LOG_ERROR("Failed to start V2X output");
+        goto cleanup;
+    }
+
     // --- 新增：启动监控服务 ---
     monitor_config_t mon_cfg = {0};
     strncpy(mon_cfg.socket_path, "/tmp/mec_system.sock", sizeof(mon_cfg.socket_path)-1);
     mon_cfg.fusion_proc = fusion_proc;
-    mec_monitor_t *monitor_service = monitor_start_service(&mon_cfg);
+    mon_cfg.video_pool = video_pool;
+    monitor_service = monitor_start_service(&mon_cfg);
     
     LOG_INFO("MEC System Running in Asynchronous Mode (Queue: %d msgs limit)", 50);
     
@@ -150,8 +172,8 @@ int main(int argc, char *argv[]) {
             struct timeval t1, t2;
             gettimeofday(&t1, NULL);
 
-            // 拿到数据，立刻投喂给融合引擎
-            fusion_processor_add_tracks(fusion_proc, incoming_msg.tracks, incoming_msg.sensor_id);
+            // 拿到数据，立刻以整帧方式投喂给融合引擎
+            fusion_processor_add_frame(fusion_proc, incoming_msg.tracks, incoming_msg.sensor_id, &incoming_msg.timestamp);
             
             // 重要：队列 pop 出来的 tracks 所有权转移给了主循环，处理完需释放引用
             track_list_release(incoming_msg.tracks);
@@ -160,19 +182,18 @@ int main(int argc, char *argv[]) {
             double lat = (t2.tv_sec - t1.tv_sec) * 1000.0 + (t2.tv_usec - t1.tv_usec) / 1000.0;
             metrics_record_frame(lat);
 
-            // 实时输出结果
-            track_list_t *fused = fusion_processor_get_tracks(fusion_proc);
+            // 实时输出结果（RSM 编码由 V2X 输出级按快照版本完成）
+            track_list_t *fused = fusion_processor_acquire_tracks(fusion_proc, NULL);
             if (fused && fused->count > 0) {
                 printf("\r[LIVE] Fused Targets: %d | Last Source: %d   ", fused->count, incoming_msg.sensor_id);
                 fflush(stdout);
-
-                // --- 新增：V2X 标准消息编码 ---
-                uint8_t v2x_buffer[2048];
-                int v2x_len = sizeof(v2x_buffer);
-                if (v2x_encode_rsm(fused, 0xABCD, v2x_buffer, &v2x_len) == 0) {
-                    LOG_DEBUG("V2X: Encoded RSM packet (%d bytes) ready for broadcast", v2x_len);
-                }
             }
+            track_list_release(fused);
+        } else if (video_pool && video_pool_finished(video_pool)) {
+            // 离线视频源（未开启循环）全部播放完毕：输出最终统计后退出
+            LOG_INFO("All video sources finished");
+            video_pool_report(video_pool);
+            running = 0;
         } else {
             // 队列空，打印心跳状态
             static time_t last_hb = 0;
@@ -181,6 +202,10 @@ int main(int argc, char *argv[]) {
                 LOG_INFO("System Heartbeat: [Queue Size: %d] [Active Tracks: %d]", 
                          mec_queue_size(msg_queue), fusion_proc->track_count);
                 metrics_report();
+                video_pool_report(video_pool);
+                radar_io_report(radar_io);
+                v2x_output_report(v2x_output);
+                v2x_udp_report(v2x_udp);
                 last_hb = now;
             }
 
@@ -199,8 +224,10 @@ cleanup:
     LOG_INFO("MEC System shutting down...");
     if (monitor_service) monitor_stop_service(monitor_service);
     if (simulator) simulator_destroy(simulator);
-    if (video_proc) { video_processor_stop(video_proc); video_processor_destroy(video_proc); }
-    if (radar_proc) { radar_processor_stop(radar_proc); radar_processor_destroy(radar_proc); }
+    if (video_pool) { video_pool_stop(video_pool); video_pool_destroy(video_pool); }
+    if (radar_io) { radar_io_stop(radar_io); radar_io_destroy(radar_io); }
+    if (v2x_output) v2x_output_destroy(v2x_output);
+    if (v2x_udp) v2x_udp_destroy(v2x_udp);
     if (fusion_proc) { fusion_processor_stop(fusion_proc); fusion_processor_destroy(fusion_proc); }
     if (msg_queue) mec_queue_destroy(msg_queue);
     if (config) config_free(config);
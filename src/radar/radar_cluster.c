@@ -0,0 +1,249 @@
+#include "mec_radar.h"
+#include <limits.h>
+
+/**
+ * @file radar_cluster.c
+ * @brief 雷达扫描内检测点聚类（网格加速 DBSCAN）
+ *
+ * 同一目标（如货车）常产生多个反射点。每轮扫描的检测点转为直角坐标后，
+ * 按 eps 大小的网格哈希分桶，邻域查询只检查相邻 3x3 个网格；
+ * 两点邻近要求距离不超过 eps 且径向速度差不超过 velocity_eps。
+ * 每个簇输出一个质心航迹（按 RCS 线性功率加权），类型与置信度由簇的
+ * 总 RCS、扩展尺寸和点数决定；DBSCAN 中的噪声点各自作为单点目标输出，
+ * 不会被丢弃。工作缓冲区在多次调用间复用。
+ */
+
+#define CLUSTER_UNVISITED  -2
+#define CLUSTER_NOISE      -1
+
+typedef struct {
+    double sum_w;
+    double sum_wx;
+    double sum_wy;
+    double sum_wv;
+    double min_x, max_x, min_y, max_y;
+    int points;
+    int min_id;
+} cluster_acc_t;
+
+struct radar_clusterer_t {
+    radar_cluster_config_t config;
+    int capacity;
+    double *x;
+    double *y;
+    int *cx;
+    int *cy;
+    int *label;
+    int *next_in_bucket;
+    int *queue;
+    int *neighbours;
+    cluster_acc_t *acc;
+    int *bucket_head;
+    int bucket_count;                 // 2 的幂
+};
+
+radar_clusterer_t* radar_clusterer_create(const radar_cluster_config_t *config) {
+    if (!config || config->eps <= 0) return NULL;
+
+    radar_clusterer_t *c = mec_calloc(1, sizeof(radar_clusterer_t));
+    if (!c) return NULL;
+    c->config = *config;
+    if (c->config.min_points < 1) c->config.min_points = 1;
+    if (c->config.velocity_eps <= 0) c->config.velocity_eps = 1e9;
+    return c;
+}
+
+void radar_clusterer_destroy(radar_clusterer_t *c) {
+    if (!c) return;
+    mec_free(c->x);
+    mec_free(c->y);
+    mec_free(c->cx);
+    mec_free(c->cy);
+    mec_free(c->label);
+    mec_free(c->next_in_bucket);
+    mec_free(c->queue);
+    mec_free(c->neighbours);
+    mec_free(c->acc);
+    mec_free(c->bucket_head);
+    mec_free(c);
+}
+
+static int ensure_capacity(radar_clusterer_t *c, int count) {
+    if (count <= c->capacity) return 0;
+    int capacity = c->capacity ? c->capacity : 64;
+    while (capacity < count) capacity *= 2;
+
+    #define GROW(field) do { \
+        void *p = mec_realloc(c->field, capacity * sizeof(*c->field)); \
+        if (!p) return -1; \
+        c->field = p; \
+    } while (0)
+    GROW(x); GROW(y); GROW(cx); GROW(cy); GROW(label);
+    GROW(next_in_bucket); GROW(queue); GROW(neighbours); GROW(acc);
+    #undef GROW
+
+    // 桶数取不小于 2 倍点数的 2 的幂，使链长保持在常数级
+    int buckets = 1;
+    while (buckets < capacity * 2) buckets <<= 1;
+    int *heads = mec_realloc(c->bucket_head, buckets * sizeof(int));
+    if (!heads) return -1;
+    c->bucket_head = heads;
+    c->bucket_count = buckets;
+    c->capacity = capacity;
+    return 0;
+}
+
+static inline int bucket_of(const radar_clusterer_t *c, int cx, int cy) {
+    unsigned int h = (unsigned int)cx * 73856093u ^ (unsigned int)cy * 19349663u;
+    return (int)(h & (unsigned int)(c->bucket_count - 1));
+}
+
+// 邻域查询（含自身），结果写入 neighbours，返回个数
+static int region_query(const radar_clusterer_t *c, const radar_detection_t *dets, int i) {
+    double eps_sq = c->config.eps * c->config.eps;
+    int n = 0;
+    for (int gy = c->cy[i] - 1; gy <= c->cy[i] + 1; gy++) {
+        for (int gx = c->cx[i] - 1; gx <= c->cx[i] + 1; gx++) {
+            for (int j = c->bucket_head[bucket_of(c, gx, gy)]; j >= 0; j = c->next_in_bucket[j]) {
+                if (c->cx[j] != gx || c->cy[j] != gy) continue;   // 哈希冲突
+                double dx = c->x[j] - c->x[i];
+                double dy = c->y[j] - c->y[i];
+                if (dx * dx + dy * dy > eps_sq) continue;
+                if (fabs(dets[j].velocity - dets[i].velocity) > c->config.velocity_eps) continue;
+                c->neighbours[n++] = j;
+            }
+        }
+    }
+    return n;
+}
+
+// 由簇的总 RCS（dBsm）和扩展尺寸判断目标类型
+static target_type_t classify(double rcs_dbsm, double extent) {
+    if (extent > 3.0 || rcs_dbsm >= 7.0) return TARGET_VEHICLE;
+    if (rcs_dbsm < 0.0) return TARGET_PEDESTRIAN;
+    return TARGET_NON_VEHICLE;
+}
+
+/**
+ * @brief 对一轮扫描的检测点聚类，每个目标追加一条质心航迹到 out
+ *
+ * 航迹 ID 取簇内最小的雷达目标 ID（雷达侧 ID 跨扫描稳定时输出也稳定）。
+ * @return 输出的目标数，失败返回 -1
+ */
+int radar_cluster_scan(radar_clusterer_t *c, const radar_detection_t *dets, int count,
+                       const radar_config_t *config, const struct timeval *scan_time, track_list_t *out) {
+    if (!c || !dets || !config || !scan_time || !out) return -1;
+    if (count <= 0) return 0;
+    if (ensure_capacity(c, count) != 0) return -1;
+
+    // 1. 极坐标 -> 直角坐标（分块批量转换），按网格哈希分桶
+    double range[RADAR_POLAR_BATCH], angle[RADAR_POLAR_BATCH];
+    for (int start = 0; start < count; start += RADAR_POLAR_BATCH) {
+        int n = count - start;
+        if (n > RADAR_POLAR_BATCH) n = RADAR_POLAR_BATCH;
+        for (int i = 0; i < n; i++) {
+            range[i] = dets[start + i].range;
+            angle[i] = dets[start + i].angle;
+        }
+        radar_polar_to_cartesian_batch(range, angle, &c->x[start], &c->y[start], n);
+    }
+
+    for (int b = 0; b < c->bucket_count; b++) c->bucket_head[b] = -1;
+    for (int i = 0; i < count; i++) {
+        c->cx[i] = (int)floor(c->x[i] / c->config.eps);
+        c->cy[i] = (int)floor(c->y[i] / c->config.eps);
+        c->label[i] = CLUSTER_UNVISITED;
+        int b = bucket_of(c, c->cx[i], c->cy[i]);
+        c->next_in_bucket[i] = c->bucket_head[b];
+        c->bucket_head[b] = i;
+    }
+
+    // 2. DBSCAN：入队时即打标签，每个点最多入队一次
+    int clusters = 0;
+    for (int i = 0; i < count; i++) {
+        if (c->label[i] != CLUSTER_UNVISITED) continue;
+        int n = region_query(c, dets, i);
+        if (n < c->config.min_points) {
+            c->label[i] = CLUSTER_NOISE;
+            continue;
+        }
+
+        int id = clusters++;
+        int head = 0, tail = 0;
+        c->label[i] = id;
+        for (int k = 0; k < n; k++) {
+            int j = c->neighbours[k];
+            if (c->label[j] == CLUSTER_UNVISITED || c->label[j] == CLUSTER_NOISE) {
+                c->label[j] = id;
+                c->queue[tail++] = j;
+            }
+        }
+        while (head < tail) {
+            int j = c->queue[head++];
+            int m = region_query(c, dets, j);
+            if (m < c->config.min_points) continue;   // 边界点不扩展
+            for (int k = 0; k < m; k++) {
+                int q = c->neighbours[k];
+                if (c->label[q] == CLUSTER_UNVISITED || c->label[q] == CLUSTER_NOISE) {
+                    c->label[q] = id;
+                    c->queue[tail++] = q;
+                }
+            }
+        }
+    }
+
+    // 噪声点各自成簇
+    for (int i = 0; i < count; i++) {
+        if (c->label[i] == CLUSTER_NOISE) c->label[i] = clusters++;
+    }
+
+    // 3. 按 RCS 线性功率加权累加
+    for (int k = 0; k < clusters; k++) {
+        memset(&c->acc[k], 0, sizeof(cluster_acc_t));
+        c->acc[k].min_id = INT_MAX;
+    }
+    for (int i = 0; i < count; i++) {
+        cluster_acc_t *a = &c->acc[c->label[i]];
+        double w = pow(10.0, dets[i].rcs / 10.0);
+        if (a->points == 0) {
+            a->min_x = a->max_x = c->x[i];
+            a->min_y = a->max_y = c->y[i];
+        } else {
+            a->min_x = fmin(a->min_x, c->x[i]);
+            a->max_x = fmax(a->max_x, c->x[i]);
+            a->min_y = fmin(a->min_y, c->y[i]);
+            a->max_y = fmax(a->max_y, c->y[i]);
+        }
+        a->sum_w += w;
+        a->sum_wx += w * c->x[i];
+        a->sum_wy += w * c->y[i];
+        a->sum_wv += w * dets[i].velocity;
+        a->points++;
+        if (dets[i].target_id < a->min_id) a->min_id = dets[i].target_id;
+    }
+
+    // 4. 输出质心航迹
+    target_track_t track;
+    memset(&track, 0, sizeof(track));
+    for (int k = 0; k < clusters; k++) {
+        const cluster_acc_t *a = &c->acc[k];
+        double x = a->sum_wx / a->sum_w;
+        double y = a->sum_wy / a->sum_w;
+        double rcs = 10.0 * log10(a->sum_w);
+        double extent = hypot(a->max_x - a->min_x, a->max_y - a->min_y);
+
+        double confidence = (rcs > -10.0 ? 0.7 : 0.5) + 0.05 * (a->points - 1);
+        track.id = a->min_id;
+        track.type = classify(rcs, extent);
+        track.position.latitude = y;
+        track.position.longitude = x;
+        track.position.altitude = 0.0;
+        track.velocity = a->sum_wv / a->sum_w;
+        track.heading = atan2(y, x) * 180.0 / M_PI;
+        track.confidence = confidence > 0.95 ? 0.95 : confidence;
+        track.sensor_id = config->radar_id;
+        track.timestamp = *scan_time;
+        track_list_add(out, &track);
+    }
+    return clusters;
+}
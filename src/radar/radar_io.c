@@ -0,0 +1,274 @@
+#include "mec_radar.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+/**
+ * @file radar_io.c
+ * @brief 多雷达共享 I/O 线程
+ *
+ * 所有雷达串口注册到同一个 epoll 实例，由一个线程等待可读事件，
+ * 数据到达即读取并交给对应雷达的解析器，无轮询、无固定休眠。
+ * epoll 超时取各雷达未完成扫描中最早的截止时间，扫描在静默到期时发布；
+ * 没有数据也没有未完成扫描时无限期阻塞，停止时通过 eventfd 唤醒。
+ * 配置了回放文件的雷达由回放源驱动（见 radar_replay.c）：PTY 方式仍走本线程，
+ * 直接注入方式不注册到 epoll。
+ */
+
+#define RADAR_IO_MAX_EVENTS 16
+
+// 生成雷达配置键：多雷达模式为 "radar.<i>.<name>"，兼容模式为 "radar.<name>"
+static const char* radar_key(char *buf, size_t size, int index, int legacy, const char *name) {
+    if (legacy) snprintf(buf, size, "radar.%s", name);
+    else snprintf(buf, size, "radar.%d.%s", index, name);
+    return buf;
+}
+
+// 雷达级配置优先，未配置时回退到全局 "radar.<name>"
+static int radar_setting_int(config_t *config, int index, int legacy, const char *name, int fallback) {
+    char key[128];
+    snprintf(key, sizeof(key), "radar.%s", name);
+    int global = config_get_int(config, key, fallback);
+    return config_get_int(config, radar_key(key, sizeof(key), index, legacy, name), global);
+}
+
+static const char* radar_setting_string(config_t *config, int index, int legacy, const char *name,
+                                       const char *fallback) {
+    char key[128];
+    snprintf(key, sizeof(key), "radar.%s", name);
+    const char *global = config_get_string(config, key, fallback);
+    return config_get_string(config, radar_key(key, sizeof(key), index, legacy, name), global);
+}
+
+static double radar_setting_double(config_t *config, int index, int legacy, const char *name, double fallback) {
+    char key[128];
+    snprintf(key, sizeof(key), "radar.%s", name);
+    double global = config_get_double(config, key, fallback);
+    return config_get_double(config, radar_key(key, sizeof(key), index, legacy, name), global);
+}
+
+radar_io_t* radar_io_create(config_t *config, mec_queue_t *target_queue) {
+    radar_io_t *io = mec_calloc(1, sizeof(radar_io_t));
+    if (!io) return NULL;
+    io->epoll_fd = -1;
+    io->wake_fd = -1;
+
+    // 未配置 radar.count 时按单雷达兼容模式读取 "radar.*"
+    int count = config_get_int(config, "radar.count", 0);
+    int legacy = (count <= 0);
+    if (legacy) count = 1;
+    if (count > RADAR_MAX_DEVICES) {
+        LOG_WARN("Radar IO: %d radars configured, limiting to %d", count, RADAR_MAX_DEVICES);
+        count = RADAR_MAX_DEVICES;
+    }
+
+    geo_site_t site;
+    geo_site_load(config, &site);
+
+    char key[128];
+    for (int i = 0; i < count; i++) {
+        radar_config_t cfg;
+        memset(&cfg, 0, sizeof(cfg));
+        strncpy(cfg.device_path, config_get_string(config, radar_key(key, sizeof(key), i, legacy, "device_path"),
+                "/dev/ttyUSB0"), sizeof(cfg.device_path) - 1);
+        cfg.radar_id = config_get_int(config, radar_key(key, sizeof(key), i, legacy, "radar_id"), 2 + i);
+        cfg.baud_rate = radar_setting_int(config, i, legacy, "baud_rate", 115200);
+        cfg.range_resolution = radar_setting_double(config, i, legacy, "range_resolution", 0.1);
+        cfg.angle_resolution = radar_setting_double(config, i, legacy, "angle_resolution", 1.0);
+        cfg.max_range = radar_setting_double(config, i, legacy, "max_range", 200.0);
+        cfg.scan_gap_ms = radar_setting_int(config, i, legacy, "scan_gap_ms", RADAR_SCAN_GAP_MS);
+        cfg.cluster.enabled = radar_setting_int(config, i, legacy, "cluster.enabled", 1);
+        cfg.cluster.eps = radar_setting_double(config, i, legacy, "cluster.eps", 2.5);
+        cfg.cluster.velocity_eps = radar_setting_double(config, i, legacy, "cluster.velocity_eps", 1.5);
+        cfg.cluster.min_points = radar_setting_int(config, i, legacy, "cluster.min_points", 2);
+        const char *protocol = radar_setting_string(config, i, legacy, "protocol", "legacy");
+        if (radar_protocol_load(config, protocol, &cfg.protocol) != 0) {
+            radar_io_destroy(io);
+            return NULL;
+        }
+        char prefix[32];
+        if (legacy) snprintf(prefix, sizeof(prefix), "radar");
+        else snprintf(prefix, sizeof(prefix), "radar.%d", i);
+        geo_pose_load(config, prefix, &site, &cfg.pose);
+        strncpy(cfg.record_path, config_get_string(config, radar_key(key, sizeof(key), i, legacy, "record_path"), ""),
+                sizeof(cfg.record_path) - 1);
+        cfg.target_queue = target_queue;
+
+        // 回放源：radar.<i>.replay_path 指定录制文件，mode = pty | realtime | fast
+        radar_replay_t *replay = NULL;
+        const char *replay_path = config_get_string(config, radar_key(key, sizeof(key), i, legacy, "replay_path"), NULL);
+        if (replay_path && replay_path[0]) {
+            const char *mode = radar_setting_string(config, i, legacy, "replay_mode", "pty");
+            replay = radar_replay_create(replay_path,
+                                         strcmp(mode, "fast") == 0 ? RADAR_REPLAY_FAST :
+                                         (strcmp(mode, "realtime") == 0 ? RADAR_REPLAY_REALTIME : RADAR_REPLAY_PTY),
+                                         radar_setting_int(config, i, legacy, "replay_loop", 0));
+            if (!replay) {
+                radar_io_destroy(io);
+                return NULL;
+            }
+            if (radar_replay_device(replay)) {
+                strncpy(cfg.device_path, radar_replay_device(replay), sizeof(cfg.device_path) - 1);
+            }
+        }
+
+        radar_processor_t *processor = radar_processor_create(&cfg);
+        if (!processor) {
+            LOG_ERROR("Radar IO: Failed to create radar %d", i);
+            radar_replay_destroy(replay);
+            radar_io_destroy(io);
+            return NULL;
+        }
+        io->replays[io->radar_count] = replay;
+        io->radars[io->radar_count++] = processor;
+    }
+
+    LOG_INFO("Radar IO: %d radar(s) configured", io->radar_count);
+    return io;
+}
+
+void radar_io_destroy(radar_io_t *io) {
+    if (!io) return;
+    radar_io_stop(io);
+    for (int i = 0; i < io->radar_count; i++) {
+        radar_replay_destroy(io->replays[i]);
+        radar_processor_destroy(io->radars[i]);
+    }
+    mec_free(io);
+}
+
+// 读空该雷达当前可读的数据并归入扫描；读取出错返回 -1
+static int radar_io_drain(radar_processor_t *processor, radar_detection_t *detections) {
+    int count;
+    do {
+        count = radar_read_data(processor, detections, RADAR_MAX_DETECTIONS);
+        if (count > 0) radar_scan_add(processor, detections, count);
+    } while (count > 0);
+    return count < 0 ? -1 : 0;
+}
+
+// 直接注入回放的雷达由回放线程独占（解析、超时发布均在该线程），I/O 线程不得触碰
+static inline int radar_io_owns(const radar_io_t *io, int i) {
+    return !io->replays[i] || radar_replay_device(io->replays[i]) != NULL;
+}
+
+static void* radar_io_thread(void *arg) {
+    radar_io_t *io = (radar_io_t*)arg;
+    struct epoll_event events[RADAR_IO_MAX_EVENTS];
+    radar_detection_t detections[RADAR_MAX_DETECTIONS];
+    struct timeval now;
+
+    while (io->thread_ctx.running) {
+        // 等到最早的扫描截止时间；无未完成扫描时无限等待
+        gettimeofday(&now, NULL);
+        long wait_ms = -1;
+        for (int i = 0; i < io->radar_count; i++) {
+            if (!radar_io_owns(io, i)) continue;
+            long t = radar_scan_timeout_ms(io->radars[i], &now);
+            if (t >= 0 && (wait_ms < 0 || t < wait_ms)) wait_ms = t;
+        }
+
+        int n = epoll_wait(io->epoll_fd, events, RADAR_IO_MAX_EVENTS, (int)wait_ms);
+        if (n < 0 && errno != EINTR) {
+            LOG_ERROR("Radar IO: epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int k = 0; k < n; k++) {
+            radar_processor_t *processor = (radar_processor_t*)events[k].data.ptr;
+            if (!processor) continue;   // wake_fd
+            int failed = (events[k].events & EPOLLIN) && radar_io_drain(processor, detections) != 0;
+            if (failed || (events[k].events & (EPOLLERR | EPOLLHUP))) {
+                LOG_ERROR("Radar IO: Device error on radar %d, removing", processor->config.radar_id);
+                epoll_ctl(io->epoll_fd, EPOLL_CTL_DEL, processor->fd, NULL);
+            }
+        }
+
+        gettimeofday(&now, NULL);
+        for (int i = 0; i < io->radar_count; i++) {
+            if (!radar_io_owns(io, i)) continue;
+            if (radar_scan_timeout_ms(io->radars[i], &now) == 0) radar_scan_flush(io->radars[i]);
+        }
+    }
+    return NULL;
+}
+
+int radar_io_start(radar_io_t *io) {
+    if (!io) return -1;
+
+    io->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    io->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (io->epoll_fd < 0 || io->wake_fd < 0) {
+        LOG_ERROR("Radar IO: Failed to create epoll/eventfd: %s", strerror(errno));
+        radar_io_stop(io);
+        return -1;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl(io->epoll_fd, EPOLL_CTL_ADD, io->wake_fd, &ev);
+
+    for (int i = 0; i < io->radar_count; i++) {
+        radar_processor_t *processor = io->radars[i];
+        if (!radar_io_owns(io, i)) continue;   // 直接注入
+        ev.data.ptr = processor;
+        if (radar_processor_start(processor) != 0 ||
+            epoll_ctl(io->epoll_fd, EPOLL_CTL_ADD, processor->fd, &ev) != 0) {
+            LOG_ERROR("Radar IO: Failed to start radar %d", processor->config.radar_id);
+            radar_io_stop(io);
+            return -1;
+        }
+    }
+
+    if (thread_create(&io->thread_ctx, radar_io_thread, io) != 0) {
+        LOG_ERROR("Radar IO: Failed to start I/O thread");
+        io->thread_ctx.running = 0;
+        radar_io_stop(io);
+        return -1;
+    }
+
+    for (int i = 0; i < io->radar_count; i++) {
+        if (io->replays[i] && radar_replay_start(io->replays[i], io->radars[i]) != 0) {
+            radar_io_stop(io);
+            return -1;
+        }
+    }
+
+    LOG_INFO("Radar IO: Started I/O thread for %d radar(s)", io->radar_count);
+    return 0;
+}
+
+void radar_io_stop(radar_io_t *io) {
+    if (!io) return;
+
+    for (int i = 0; i < io->radar_count; i++) radar_replay_stop(io->replays[i]);
+
+    if (io->thread_ctx.running) {
+        io->thread_ctx.running = 0;
+        uint64_t one = 1;
+        if (write(io->wake_fd, &one, sizeof(one)) < 0) LOG_WARN("Radar IO: Failed to wake I/O thread");
+        thread_destroy(&io->thread_ctx);
+    }
+
+    // 关闭串口并发布未完成的扫描
+    for (int i = 0; i < io->radar_count; i++) radar_processor_stop(io->radars[i]);
+
+    if (io->epoll_fd >= 0) close(io->epoll_fd);
+    if (io->wake_fd >= 0) close(io->wake_fd);
+    io->epoll_fd = -1;
+    io->wake_fd = -1;
+}
+
+void radar_io_report(radar_io_t *io) {
+    if (!io) return;
+    for (int i = 0; i < io->radar_count; i++) {
+        const radar_processor_t *p = io->radars[i];
+        LOG_INFO("Radar %d (%s): frames %ld (%ld targets), checksum errors %ld, discarded %ld B, "
+                 "scans %ld, detections %ld -> objects %ld%s",
+                 p->config.radar_id, p->config.protocol.name, p->frames_decoded, p->detections_decoded,
+                 p->checksum_errors, p->bytes_discarded,
+                 p->scans_published, p->detections_in, p->objects_out,
+                 radar_replay_finished(io->replays[i]) ? " (replay finished)" : "");
+    }
+}
@@ -0,0 +1,51 @@
+#include "mec_radar.h"
+
+/**
+ * @file radar_polar.c
+ * @brief 雷达检测点极坐标 -> 直角坐标批量转换
+ *
+ * 雷达角度按 0.1° 量化，sin/cos 取自 0.1° 分度的查找表（所有雷达共用，
+ * 首次使用时构建）。不在分度上的角度（如 0.01° 分辨率的协议）以残差 d
+ * 做二阶修正：sin(a+d) ≈ sin a (1 - d²/2) + cos a d，|d| ≤ 0.05° 时
+ * 误差约 1e-10，200 m 处远小于 1 µm。批量接口按 SoA 数组处理，
+ * 循环体只有查表与乘加，无 libm 调用。
+ */
+
+#define POLAR_LUT_STEPS_PER_DEG  10
+#define POLAR_LUT_SIZE           (360 * POLAR_LUT_STEPS_PER_DEG)
+
+static double polar_cos[POLAR_LUT_SIZE];
+static double polar_sin[POLAR_LUT_SIZE];
+static pthread_once_t polar_once = PTHREAD_ONCE_INIT;
+
+static void polar_lut_init(void) {
+    for (int i = 0; i < POLAR_LUT_SIZE; i++) {
+        double a = (double)i / POLAR_LUT_STEPS_PER_DEG * M_PI / 180.0;
+        polar_cos[i] = cos(a);
+        polar_sin[i] = sin(a);
+    }
+}
+
+/**
+ * @brief 批量极坐标转换：range（米）/ angle（度）-> x / y（米）
+ *
+ * 输入输出为独立数组，不可重叠。
+ */
+void radar_polar_to_cartesian_batch(const double *restrict range, const double *restrict angle,
+                                    double *restrict x, double *restrict y, int count) {
+    pthread_once(&polar_once, polar_lut_init);
+    const double step_rad = M_PI / 180.0 / POLAR_LUT_STEPS_PER_DEG;
+
+    for (int i = 0; i < count; i++) {
+        double steps = angle[i] * POLAR_LUT_STEPS_PER_DEG;
+        double bin = nearbyint(steps);
+        double d = (steps - bin) * step_rad;
+        int idx = (int)bin % POLAR_LUT_SIZE;
+        idx += (idx < 0) ? POLAR_LUT_SIZE : 0;
+
+        double c = polar_cos[idx], s = polar_sin[idx];
+        double half_d2 = 0.5 * d * d;
+        x[i] = range[i] * (c - c * half_d2 - s * d);
+        y[i] = range[i] * (s - s * half_d2 + c * d);
+    }
+}
@@ -1,7 +1,6 @@
 #include "mec_radar.h"
 #include <fcntl.h>
 #include <termios.h>
-#include <sys/select.h>
 
 radar_processor_t* radar_processor_create(const radar_config_t *config) {
     if (!config) return NULL;
@@ -10,13 +9,41 @@ radar_processor_t* radar_processor_create(const radar_config_t *config) {
     if (!processor) return NULL;
     
     processor->config = *config;
-    processor->output_tracks = track_list_create(50);
+    track_list_ring_init(&processor->output_ring, 64);
+    processor->output_tracks = track_list_ring_acquire(&processor->output_ring);
     processor->fd = -1;
+    processor->rx_len = 0;
+    processor->frames_decoded = 0;
+    processor->detections_decoded = 0;
+    if (processor->config.protocol.sync_len == 0) radar_protocol_legacy(&processor->config.protocol);
+    if (processor->config.pose.enu[0] == 0.0 && processor->config.pose.enu[3] == 0.0) {
+        // 未设置位姿：传感器坐标系即站点平面，输出保持米制
+        geo_site_t identity;
+        geo_site_init(&identity, NULL);
+        geo_pose_init(&processor->config.pose, &identity, 0.0, 0.0, 90.0);
+    }
+    processor->checksum_errors = 0;
+    processor->bytes_discarded = 0;
+    processor->scan_count = 0;
+    processor->scan_capacity = 64;
+    processor->scan = mec_malloc(processor->scan_capacity * sizeof(radar_detection_t));
+    processor->scans_published = 0;
+    processor->detections_in = 0;
+    processor->objects_out = 0;
+    processor->clusterer = processor->config.cluster.enabled ? radar_clusterer_create(&processor->config.cluster) : NULL;
+    processor->record = NULL;
+    if (processor->config.scan_gap_ms < 0) processor->config.scan_gap_ms = RADAR_SCAN_GAP_MS;
     
-    if (!processor->output_tracks) {
+    if (!processor->output_tracks || !processor->scan ||
+        (processor->config.cluster.enabled && !processor->clusterer)) {
+        if (processor->output_tracks) track_list_release(processor->output_tracks);
+        track_list_ring_destroy(&processor->output_ring);
+        radar_clusterer_destroy(processor->clusterer);
+        mec_free(processor->scan);
         mec_free(processor);
         return NULL;
     }
+    pthread_mutex_init(&processor->lock, NULL);
     
     LOG_INFO("Created radar processor for radar %d", config->radar_id);
     return processor;
@@ -26,10 +53,11 @@ void radar_processor_destroy(radar_processor_t *processor) {
     if (!processor) return;
     
     radar_processor_stop(processor);
-    if (processor->fd >= 0) {
-        close(processor->fd);
-    }
+    radar_clusterer_destroy(processor->clusterer);
+    mec_free(processor->scan);
     track_list_release(processor->output_tracks);
+    track_list_ring_destroy(&processor->output_ring);
+    pthread_mutex_destroy(&processor->lock);
     mec_free(processor);
 }
 
@@ -78,6 +106,19 @@ static int setup_serial_port(const char *device_path, int baud_rate) {
         case 38400: speed = B38400; break;
         case 57600: speed = B57600; break;
         case 115200: speed = B115200; break;
+        case 230400: speed = B230400; break;
+#ifdef B460800
+        case 460800: speed = B460800; break;
+#endif
+#ifdef B921600
+        case 921600: speed = B921600; break;
+#endif
+#ifdef B1000000
+        case 1000000: speed = B1000000; break;
+#endif
+#ifdef B2000000
+        case 2000000: speed = B2000000; break;
+#endif
         default:
             LOG_ERROR("Unsupported baud rate: %d", baud_rate);
             close(fd);
@@ -96,6 +137,9 @@ static int setup_serial_port(const char *device_path, int baud_rate) {
     return fd;
 }
 
+/**
+ * @brief 打开雷达串口（非阻塞），读取由 radar_io 的 I/O 线程统一驱动
+ */
 int radar_processor_start(radar_processor_t *processor) {
     if (!processor) return -1;
     
@@ -103,12 +147,11 @@ int radar_processor_start(radar_processor_t *processor) {
     if (processor->fd < 0) {
         return -1;
     }
+    processor->rx_len = 0;
     
-    if (thread_create(&processor->thread_ctx, radar_processing_thread, processor) != 0) {
-        LOG_ERROR("Failed to start radar processing thread");
-        close(processor->fd);
-        processor->fd = -1;
-        return -1;
+    if (processor->config.record_path[0]) {
+        processor->record = radar_record_open(processor->config.record_path);
+        if (!processor->record) LOG_WARN("Radar: Recording disabled for radar %d", processor->config.radar_id);
     }
     
     LOG_INFO("Started radar processor for radar %d", processor->config.radar_id);
@@ -116,12 +159,14 @@ int radar_processor_start(radar_processor_t *processor) {
 }
 
 void radar_processor_stop(radar_processor_t *processor) {
-    if (!processor) return;
+    if (!processor || processor->fd < 0) return;
     
-    thread_destroy(&processor->thread_ctx);
-    if (processor->fd >= 0) {
-        close(processor->fd);
-        processor->fd = -1;
+    close(processor->fd);
+    processor->fd = -1;
+    radar_scan_flush(processor);
+    if (processor->record) {
+        radar_record_close(processor->record);
+        processor->record = NULL;
     }
     LOG_INFO("Stopped radar processor for radar %d", processor->config.radar_id);
 }
@@ -131,98 +176,280 @@ track_list_t* radar_processor_get_tracks(radar_processor_t *processor) {
     return processor->output_tracks;
 }
 
-void* radar_processing_thread(void *arg) {
-    radar_processor_t *processor = (radar_processor_t*)arg;
-    if (!processor) return NULL;
-    
-    radar_detection_t detection;
+static long elapsed_ms(const struct timeval *from, const struct timeval *to) {
+    return (to->tv_sec - from->tv_sec) * 1000L + (to->tv_usec - from->tv_usec) / 1000L;
+}
+
+static int scan_contains(const radar_processor_t *processor, int target_id) {
+    for (int i = 0; i < processor->scan_count; i++) {
+        if (processor->scan[i].target_id == target_id) return 1;
+    }
+    return 0;
+}
+
+// 航向取检测点方位角，归一化到 (-180, 180]（与 atan2(y, x) 一致）
+static inline double angle_to_heading(double angle) {
+    double heading = fmod(angle, 360.0);
+    if (heading > 180.0) heading -= 360.0;
+    else if (heading <= -180.0) heading += 360.0;
+    return heading;
+}
+
+// 未启用聚类时逐点输出：按 RADAR_POLAR_BATCH 分块收集为 SoA 后批量转换
+static void convert_scan(const radar_processor_t *processor, int count, track_list_t *out) {
+    double range[RADAR_POLAR_BATCH], angle[RADAR_POLAR_BATCH];
+    double x[RADAR_POLAR_BATCH], y[RADAR_POLAR_BATCH];
     target_track_t track;
-    
-    while (processor->thread_ctx.running) {
-        if (radar_read_data(processor, &detection) == 0) {
-            if (radar_convert_to_track(&detection, &processor->config, &track) == 0) {
-                thread_lock(&processor->thread_ctx);
-                track_list_add(processor->output_tracks, &track);
-                
-                // --- 新增：将结果推送至异步队列 ---
-                if (processor->config.target_queue) {
-                    mec_msg_t msg;
-                    msg.sensor_id = processor->config.radar_id;
-                    msg.tracks = processor->output_tracks; 
-                    msg.timestamp = detection.timestamp;
-                    mec_queue_push(processor->config.target_queue, &msg);
-                }
-                
-                thread_unlock(&processor->thread_ctx);
-            }
+    memset(&track, 0, sizeof(track));
+
+    for (int start = 0; start < count; start += RADAR_POLAR_BATCH) {
+        int n = count - start;
+        if (n > RADAR_POLAR_BATCH) n = RADAR_POLAR_BATCH;
+        const radar_detection_t *d = &processor->scan[start];
+
+        for (int i = 0; i < n; i++) {
+            range[i] = d[i].range;
+            angle[i] = d[i].angle;
+        }
+        radar_polar_to_cartesian_batch(range, angle, x, y, n);
+
+        for (int i = 0; i < n; i++) {
+            track.id = d[i].target_id;
+            track.type = TARGET_VEHICLE;
+            track.position.latitude = y[i];
+            track.position.longitude = x[i];
+            track.velocity = d[i].velocity;
+            track.heading = angle_to_heading(d[i].angle);
+            track.confidence = (d[i].rcs > -10.0) ? 0.8 : 0.5;
+            track.sensor_id = processor->config.radar_id;
+            track.timestamp = processor->scan_time;
+            track_list_add(out, &track);
         }
-        
-        usleep(10000); // 10ms
     }
-    
-    return NULL;
 }
 
 /**
- * @brief 鲁棒的雷达数据读取逻辑（基于有限状态机 DFA）
- * 
- * 能够自动处理串口字节对齐、丢包和干扰，确保只有完整且校验通过的数据包才会进入算法层。
+ * @brief 发布当前扫描：整轮检测（启用聚类时为聚类后的目标）作为
+ *        一个新的航迹列表推入队列
+ *
+ * 目标由传感器坐标系经安装位姿转换为 WGS84 后发布。
+ * 推入队列的列表不会再被修改；output_tracks 替换为最新一轮扫描。
+ * 扫描列表取自发布环，队列与读者全部释放后才会被下一轮复用。
  */
-int radar_read_data(radar_processor_t *processor, radar_detection_t *detection) {
-    if (!processor || !detection || processor->fd < 0) return -1;
-    
-    // 状态定义
-    typedef enum { STATE_IDLE, STATE_HEAD1, STATE_HEAD2, STATE_DATA, STATE_CHECK } parse_state_t;
-    static parse_state_t state = STATE_IDLE;
-    static unsigned char frame_buf[16];
-    static int frame_idx = 0;
-    
-    unsigned char ch;
-    // 每次从内核缓冲区读取一个字节进行状态机处理
-    while (read(processor->fd, &ch, 1) > 0) {
-        switch (state) {
-            case STATE_IDLE:
-                if (ch == 0xAA) state = STATE_HEAD1;
-                break;
-            case STATE_HEAD1:
-                if (ch == 0x55) {
-                    state = STATE_DATA;
-                    frame_idx = 0;
-                } else {
-                    state = STATE_IDLE;
-                }
-                break;
-            case STATE_DATA:
-                frame_buf[frame_idx++] = ch;
-                if (frame_idx >= 14) { // 假设数据段为 14 字节
-                    state = STATE_CHECK;
-                }
-                break;
-            case STATE_CHECK:
-                // 简单的校验和检查 (Sum Check)
-                unsigned char checksum = 0;
-                for (int i = 0; i < 14; i++) checksum ^= frame_buf[i];
-                
-                if (ch == checksum) {
-                    // 校验通过，解析数据
-                    detection->target_id = (frame_buf[0] << 8) | frame_buf[1];
-                    detection->range = ((frame_buf[2] << 8) | frame_buf[3]) * 0.1;
-                    detection->angle = ((frame_buf[4] << 8) | frame_buf[5]) * 0.1 - 180.0;
-                    detection->velocity = ((frame_buf[6] << 8) | frame_buf[7]) * 0.1;
-                    detection->rcs = ((frame_buf[8] << 8) | frame_buf[9]) * 0.1 - 50.0;
-                    gettimeofday(&detection->timestamp, NULL);
-                    
-                    state = STATE_IDLE;
-                    return 0; // 成功解析一帧
-                } else {
-                    LOG_WARN("Radar: Checksum error (Exp: 0x%02X, Got: 0x%02X)", checksum, ch);
-                    state = STATE_IDLE;
-                }
-                break;
+int radar_scan_flush(radar_processor_t *processor) {
+    if (!processor || processor->scan_count == 0) return 0;
+
+    int count = processor->scan_count;
+    processor->scan_count = 0;
+    track_list_t *scan = track_list_ring_acquire(&processor->output_ring);
+    if (!scan) return 0;
+
+    if (processor->clusterer) {
+        radar_cluster_scan(processor->clusterer, processor->scan, count, &processor->config,
+                           &processor->scan_time, scan);
+    } else {
+        convert_scan(processor, count, scan);
+    }
+    geo_tracks_sensor_to_wgs84(&processor->config.pose, scan->tracks, scan->count);
+    processor->detections_in += count;
+    processor->objects_out += scan->count;
+
+    if (processor->config.target_queue) {
+        mec_msg_t msg;
+        msg.sensor_id = processor->config.radar_id;
+        msg.tracks = scan;
+        msg.timestamp = processor->scan_time;
+        mec_queue_push(processor->config.target_queue, &msg);
+    }
+
+    pthread_mutex_lock(&processor->lock);
+    track_list_t *previous = processor->output_tracks;
+    processor->output_tracks = scan;
+    pthread_mutex_unlock(&processor->lock);
+    track_list_release(previous);
+
+    processor->scans_published++;
+    return 1;
+}
+
+/**
+ * @brief 将检测归入扫描周期，完整的扫描立即发布
+ *
+ * 以下情况视为新一轮扫描开始：距上一帧的静默超过 scan_gap_ms，
+ * 或目标 ID 在当前扫描中已出现（同一目标一轮内只上报一次）。
+ * 协议无 ID 字段时只按静默分割，检测按其在扫描内的序号编号。
+ * scan_gap_ms 为 0 时不做静默判断，每批读取到的检测直接作为一轮发布。
+ * 同一扫描内的航迹使用统一的扫描时间戳。
+ * @return 本次发布的扫描数
+ */
+int radar_scan_add(radar_processor_t *processor, const radar_detection_t *detections, int count) {
+    if (!processor || !detections) return 0;
+
+    int published = 0;
+    for (int i = 0; i < count; i++) {
+        const radar_detection_t *det = &detections[i];
+        int anonymous = det->target_id == RADAR_TARGET_ID_NONE;
+        if (processor->scan_count > 0 &&
+            ((processor->config.scan_gap_ms > 0 &&
+              elapsed_ms(&processor->last_arrival, &det->timestamp) >= processor->config.scan_gap_ms) ||
+             (!anonymous && scan_contains(processor, det->target_id)))) {
+            published += radar_scan_flush(processor);
         }
+        processor->last_arrival = det->timestamp;
+
+        if (processor->scan_count == processor->scan_capacity) {
+            radar_detection_t *grown = mec_realloc(processor->scan,
+                                                   processor->scan_capacity * 2 * sizeof(radar_detection_t));
+            if (!grown) continue;
+            processor->scan = grown;
+            processor->scan_capacity *= 2;
+        }
+        if (processor->scan_count == 0) processor->scan_time = det->timestamp;
+        processor->scan[processor->scan_count] = *det;
+        if (anonymous) processor->scan[processor->scan_count].target_id = processor->scan_count;
+        processor->scan_count++;
     }
-    
-    return -1;
+    if (processor->config.scan_gap_ms == 0) published += radar_scan_flush(processor);
+    return published;
+}
+
+/**
+ * @brief 距当前扫描超时关闭还剩多少毫秒
+ *
+ * @return 无未完成扫描时返回 -1；0 表示应立即发布
+ */
+long radar_scan_timeout_ms(const radar_processor_t *processor, const struct timeval *now) {
+    if (!processor || processor->scan_count == 0) return -1;
+    long remaining = processor->config.scan_gap_ms - elapsed_ms(&processor->last_arrival, now);
+    return remaining > 0 ? remaining : 0;
+}
+
+/**
+ * @brief 解析接收缓冲区中所有完整的数据帧
+ *
+ * 按雷达的协议描述用 memchr 查找同步字，由帧头得到帧长，校验通过后
+ * 一次解码帧内全部目标并跳过整帧；校验失败或帧头非法只前移一个字节
+ * 重新同步（帧内可能含有真正的帧头）。未解析完的尾部（不完整的帧）
+ * 移到缓冲区开头等待下次读取；detections 放不下下一帧时提前返回。
+ * 解析状态全部在 processor 中，多个雷达实例互不影响。
+ * @param arrival 本批数据的到达时间，作为各检测的时间戳
+ * @return 解码出的检测数
+ */
+int radar_parse_buffer(radar_processor_t *processor, const struct timeval *arrival,
+                       radar_detection_t *detections, int max_detections) {
+    const radar_protocol_t *protocol = &processor->config.protocol;
+    unsigned char *buf = processor->rx_buf;
+    size_t len = processor->rx_len;
+    size_t sync_len = (size_t)protocol->sync_len;
+    size_t pos = 0;
+    int count = 0;
+
+    while (len - pos >= sync_len) {
+        unsigned char *sync = memchr(buf + pos, protocol->sync[0], len - pos);
+        if (!sync) {
+            processor->bytes_discarded += len - pos;
+            pos = len;
+            break;
+        }
+        size_t at = (size_t)(sync - buf);
+        processor->bytes_discarded += at - pos;
+        pos = at;
+
+        if (len - pos < sync_len) break;
+        if (memcmp(buf + pos, protocol->sync, sync_len) != 0) {
+            pos++;
+            processor->bytes_discarded++;
+            continue;
+        }
+
+        int frame_len = radar_protocol_frame_length(protocol, buf + pos, len - pos);
+        if (frame_len < 0) {
+            pos++;
+            processor->bytes_discarded++;
+            continue;
+        }
+        if (frame_len == 0 || len - pos < (size_t)frame_len) break; // 等待帧的剩余部分
+
+        if (!radar_protocol_verify(protocol, buf + pos, frame_len)) {
+            processor->checksum_errors++;
+            // 计入 checksum_errors 由 radar_io_report 汇总；逐帧仅调试输出，避免噪声线路刷屏
+            LOG_DEBUG("Radar %d: Checksum error in %d-byte frame", processor->config.radar_id, frame_len);
+            pos++;
+            continue;
+        }
+
+        int targets = (frame_len - protocol->target_offset) / protocol->target_stride;
+        if (count + targets > max_detections) break;
+        count += radar_protocol_decode(protocol, buf + pos, frame_len, arrival,
+                                       detections + count, max_detections - count);
+        pos += (size_t)frame_len;
+        processor->frames_decoded++;
+    }
+
+    if (pos > 0) {
+        memmove(buf, buf + pos, len - pos);
+        processor->rx_len = len - pos;
+    }
+    processor->detections_decoded += count;
+    return count;
+}
+
+/**
+ * @brief 读取串口数据并解码（非阻塞，一次尽量读满接收缓冲区）
+ *
+ * @return 解码出的检测数（可能为 0），读取出错返回 -1
+ */
+int radar_read_data(radar_processor_t *processor, radar_detection_t *detections, int max_detections) {
+    if (!processor || !detections || max_detections <= 0 || processor->fd < 0) return -1;
+
+    struct timeval arrival;
+    gettimeofday(&arrival, NULL);
+
+    int error = 0;
+    while (processor->rx_len < RADAR_RX_BUFFER_SIZE) {
+        unsigned char *dst = processor->rx_buf + processor->rx_len;
+        ssize_t n = read(processor->fd, dst, RADAR_RX_BUFFER_SIZE - processor->rx_len);
+        if (n > 0) {
+            if (processor->record) radar_record_write(processor->record, &arrival, dst, (size_t)n);
+            processor->rx_len += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) error = 1;
+        break;
+    }
+
+    int count = radar_parse_buffer(processor, &arrival, detections, max_detections);
+    if (count == 0 && error) return -1;
+    return count;
+}
+
+/**
+ * @brief 直接向解析器注入原始字节（回放源使用，不经过串口）
+ *
+ * 数据按接收缓冲区剩余空间分块拷入并解析，解出的检测按 arrival
+ * 归入扫描，行为与串口读取一致。
+ * @return 解码出的检测数
+ */
+int radar_processor_feed(radar_processor_t *processor, const unsigned char *data, size_t len,
+                         const struct timeval *arrival) {
+    if (!processor || (!data && len > 0) || !arrival) return -1;
+
+    radar_detection_t detections[RADAR_MAX_DETECTIONS];
+    int total = 0;
+    int count;
+    do {
+        size_t chunk = RADAR_RX_BUFFER_SIZE - processor->rx_len;
+        if (chunk > len) chunk = len;
+        memcpy(processor->rx_buf + processor->rx_len, data, chunk);
+        processor->rx_len += chunk;
+        data += chunk;
+        len -= chunk;
+
+        count = radar_parse_buffer(processor, arrival, detections, RADAR_MAX_DETECTIONS);
+        radar_scan_add(processor, detections, count);
+        total += count;
+    } while (len > 0 || count > 0);
+    return total;
 }
 
 int radar_convert_to_track(const radar_detection_t *detection, 
@@ -238,11 +465,11 @@ int radar_convert_to_track(const radar_detection_t *detection,
     
     track->id = detection->target_id;
     track->type = TARGET_VEHICLE; // Default, could be refined based on RCS
-    track->position.latitude = y;  // Simplified - in practice would convert to WGS84
+    track->position.latitude = y;  // Sensor frame; radar_scan_flush projects through the mount pose
     track->position.longitude = x;
     track->position.altitude = 0.0;
     track->velocity = detection->velocity;
-    track->heading = atan2(y, x) * 180.0 / M_PI;
+    track->heading = angle_to_heading(detection->angle);
     track->confidence = (detection->rcs > -10.0) ? 0.8 : 0.5; // Based on RCS
     track->sensor_id = config->radar_id;
     track->timestamp = detection->timestamp;
@@ -0,0 +1,273 @@
+#include "mec_radar.h"
+
+/**
+ * @file radar_protocol.c
+ * @brief 表驱动的雷达帧协议描述与通用解码
+ *
+ * 每种雷达型号的帧格式用 radar_protocol_t 描述：同步字、字节序、
+ * 帧头中的目标数字段、目标记录的起始偏移与步长、各字段的偏移/宽度/
+ * 符号/比例/偏置，以及帧尾校验类型。通用解码器一次处理整帧中的全部目标。
+ * 描述从配置 "radar.protocols.<name>.*" 加载；内置 "legacy" 为原有的
+ * 单目标 17 字节帧（0xAA 0x55 | 14 字节数据 | XOR 校验）。
+ *
+ * 配置示例（每个目标 12 字节、帧头带目标数、CRC16 校验）：
+ *   radar.protocols.mr80.sync=A5A5
+ *   radar.protocols.mr80.endian=little
+ *   radar.protocols.mr80.count=2:1:u
+ *   radar.protocols.mr80.max_targets=64
+ *   radar.protocols.mr80.target_offset=3
+ *   radar.protocols.mr80.target_stride=12
+ *   radar.protocols.mr80.field.id=0:2:u:1:0
+ *   radar.protocols.mr80.field.range=2:2:u:0.01:0
+ *   radar.protocols.mr80.field.angle=4:2:s:0.01:0
+ *   radar.protocols.mr80.field.velocity=6:2:s:0.01:0
+ *   radar.protocols.mr80.field.rcs=8:1:s:0.5:0
+ *   radar.protocols.mr80.checksum=crc16
+ *   radar.protocols.mr80.checksum_start=2
+ * 字段格式为 "偏移:宽度:u|s:比例:偏置"，目标字段的偏移相对目标记录起点。
+ */
+
+static const char *field_names[RADAR_FIELD_COUNT] = {"id", "range", "angle", "velocity", "rcs"};
+
+static int checksum_size(radar_checksum_t type) {
+    switch (type) {
+        case RADAR_CHECKSUM_XOR:
+        case RADAR_CHECKSUM_SUM8: return 1;
+        case RADAR_CHECKSUM_CRC16: return 2;
+        default: return 0;
+    }
+}
+
+static uint32_t read_raw(const unsigned char *p, int size, int big_endian) {
+    uint32_t v = 0;
+    for (int i = 0; i < size; i++) {
+        v |= (uint32_t)p[big_endian ? i : size - 1 - i] << (8 * (size - 1 - i));
+    }
+    return v;
+}
+
+static double field_value(const radar_protocol_t *protocol, const radar_field_t *field, const unsigned char *base) {
+    if (field->size == 0) return field->bias;
+    uint32_t raw = read_raw(base + field->offset, field->size, protocol->big_endian);
+    double v;
+    if (field->is_signed) {
+        if (field->size == 1) v = (int8_t)raw;
+        else if (field->size == 2) v = (int16_t)raw;
+        else v = (int32_t)raw;
+    } else {
+        v = raw;
+    }
+    return v * field->scale + field->bias;
+}
+
+static uint16_t crc16_table[256];
+static pthread_once_t crc16_once = PTHREAD_ONCE_INIT;
+
+static void crc16_init(void) {
+    for (int i = 0; i < 256; i++) {
+        uint16_t c = (uint16_t)(i << 8);
+        for (int k = 0; k < 8; k++) c = (c & 0x8000) ? (uint16_t)((c << 1) ^ 0x1021) : (uint16_t)(c << 1);
+        crc16_table[i] = c;
+    }
+}
+
+static uint16_t crc16_ccitt(const unsigned char *data, int len) {
+    pthread_once(&crc16_once, crc16_init);
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < len; i++) crc = (uint16_t)((crc << 8) ^ crc16_table[((crc >> 8) ^ data[i]) & 0xFF]);
+    return crc;
+}
+
+static void set_field(radar_field_t *field, int offset, int size, int is_signed, double scale, double bias) {
+    field->offset = offset;
+    field->size = size;
+    field->is_signed = is_signed;
+    field->scale = scale;
+    field->bias = bias;
+}
+
+void radar_protocol_legacy(radar_protocol_t *protocol) {
+    memset(protocol, 0, sizeof(*protocol));
+    strncpy(protocol->name, "legacy", sizeof(protocol->name) - 1);
+    protocol->sync[0] = 0xAA;
+    protocol->sync[1] = 0x55;
+    protocol->sync_len = 2;
+    protocol->big_endian = 1;
+    protocol->target_count = 1;
+    protocol->max_targets = 1;
+    protocol->target_offset = 2;
+    protocol->target_stride = 14;
+    set_field(&protocol->fields[RADAR_FIELD_ID], 0, 2, 0, 1.0, 0.0);
+    set_field(&protocol->fields[RADAR_FIELD_RANGE], 2, 2, 0, 0.1, 0.0);
+    set_field(&protocol->fields[RADAR_FIELD_ANGLE], 4, 2, 0, 0.1, -180.0);
+    set_field(&protocol->fields[RADAR_FIELD_VELOCITY], 6, 2, 0, 0.1, 0.0);
+    set_field(&protocol->fields[RADAR_FIELD_RCS], 8, 2, 0, 0.1, -50.0);
+    protocol->checksum = RADAR_CHECKSUM_XOR;
+    protocol->checksum_start = 2;
+}
+
+// 解析 "偏移:宽度:u|s[:比例[:偏置]]"；未配置时保持原值
+static int parse_field(const char *text, radar_field_t *field) {
+    if (!text) return 0;
+    int offset, size;
+    char sign = 'u';
+    double scale = 1.0, bias = 0.0;
+    if (sscanf(text, "%d:%d:%c:%lf:%lf", &offset, &size, &sign, &scale, &bias) < 2 ||
+        offset < 0 || (size != 0 && size != 1 && size != 2 && size != 4)) {
+        return -1;
+    }
+    set_field(field, offset, size, sign == 's', scale, bias);
+    return 0;
+}
+
+static const char* protocol_key(char *buf, size_t size, const char *name, const char *key) {
+    snprintf(buf, size, "radar.protocols.%s.%s", name, key);
+    return buf;
+}
+
+/**
+ * @brief 加载名为 name 的协议描述（未配置的项取 legacy 的值）
+ * @return 0 成功，-1 描述无效
+ */
+int radar_protocol_load(config_t *config, const char *name, radar_protocol_t *protocol) {
+    radar_protocol_legacy(protocol);
+    if (!name || !name[0] || strcmp(name, "legacy") == 0) return 0;
+    strncpy(protocol->name, name, sizeof(protocol->name) - 1);
+
+    char key[160];
+    const char *v;
+    if ((v = config_get_string(config, protocol_key(key, sizeof(key), name, "sync"), NULL))) {
+        int n = 0;
+        unsigned int byte;
+        while (n < RADAR_MAX_SYNC && sscanf(v + 2 * n, "%2x", &byte) == 1) protocol->sync[n++] = (unsigned char)byte;
+        protocol->sync_len = n;
+    }
+    if ((v = config_get_string(config, protocol_key(key, sizeof(key), name, "endian"), NULL))) {
+        protocol->big_endian = strcmp(v, "little") != 0;
+    }
+    if ((v = config_get_string(config, protocol_key(key, sizeof(key), name, "count"), NULL))) {
+        int offset, size;
+        char sign = 'u';
+        if (sscanf(v, "%d:%d:%c", &offset, &size, &sign) < 2 ||
+            offset < 0 || (size != 1 && size != 2 && size != 4)) {
+            LOG_ERROR("Radar Protocol %s: Invalid count field '%s'", name, v);
+            return -1;
+        }
+        set_field(&protocol->count, offset, size, 0, 1.0, 0.0);
+    }
+    protocol->target_count = config_get_int(config, protocol_key(key, sizeof(key), name, "target_count"),
+                                            protocol->target_count);
+    protocol->max_targets = config_get_int(config, protocol_key(key, sizeof(key), name, "max_targets"),
+                                           protocol->count.size ? 64 : protocol->target_count);
+    protocol->target_offset = config_get_int(config, protocol_key(key, sizeof(key), name, "target_offset"),
+                                             protocol->target_offset);
+    protocol->target_stride = config_get_int(config, protocol_key(key, sizeof(key), name, "target_stride"),
+                                             protocol->target_stride);
+    for (int f = 0; f < RADAR_FIELD_COUNT; f++) {
+        char field_key[32];
+        snprintf(field_key, sizeof(field_key), "field.%s", field_names[f]);
+        v = config_get_string(config, protocol_key(key, sizeof(key), name, field_key), NULL);
+        if (parse_field(v, &protocol->fields[f]) != 0) {
+            LOG_ERROR("Radar Protocol %s: Invalid field %s '%s'", name, field_names[f], v);
+            return -1;
+        }
+    }
+    if ((v = config_get_string(config, protocol_key(key, sizeof(key), name, "checksum"), NULL))) {
+        protocol->checksum = strcmp(v, "xor") == 0 ? RADAR_CHECKSUM_XOR :
+                             strcmp(v, "sum8") == 0 ? RADAR_CHECKSUM_SUM8 :
+                             strcmp(v, "crc16") == 0 ? RADAR_CHECKSUM_CRC16 : RADAR_CHECKSUM_NONE;
+    }
+    protocol->checksum_start = config_get_int(config, protocol_key(key, sizeof(key), name, "checksum_start"),
+                                              protocol->checksum_start);
+
+    // 校验描述的一致性
+    int max_frame = protocol->target_offset + protocol->max_targets * protocol->target_stride +
+                    checksum_size(protocol->checksum);
+    int valid = protocol->sync_len > 0 && protocol->target_stride > 0 &&
+                protocol->max_targets > 0 && protocol->max_targets <= RADAR_MAX_DETECTIONS &&
+                protocol->target_offset >= protocol->sync_len && max_frame <= RADAR_RX_BUFFER_SIZE &&
+                protocol->checksum_start >= 0 && protocol->checksum_start <= protocol->target_offset &&
+                protocol->count.offset + protocol->count.size <= protocol->target_offset &&
+                protocol->fields[RADAR_FIELD_RANGE].size > 0 && protocol->fields[RADAR_FIELD_ANGLE].size > 0;
+    for (int f = 0; f < RADAR_FIELD_COUNT; f++) {
+        if (protocol->fields[f].offset + protocol->fields[f].size > protocol->target_stride) valid = 0;
+    }
+    if (!valid) {
+        LOG_ERROR("Radar Protocol %s: Inconsistent frame description", name);
+        return -1;
+    }
+
+    LOG_INFO("Radar Protocol %s: %d-byte sync, %s targets x %d bytes (max frame %d bytes)", name,
+             protocol->sync_len, protocol->count.size ? "counted" : "fixed", protocol->target_stride, max_frame);
+    return 0;
+}
+
+/**
+ * @brief 由帧头计算整帧长度
+ *
+ * @param frame 指向同步字起点
+ * @param available frame 起可用的字节数
+ * @return 帧长；0 表示帧头不完整需更多数据；-1 表示帧头非法（目标数超限）
+ */
+int radar_protocol_frame_length(const radar_protocol_t *protocol, const unsigned char *frame, size_t available) {
+    int targets = protocol->target_count;
+    if (protocol->count.size) {
+        if (available < (size_t)(protocol->count.offset + protocol->count.size)) return 0;
+        targets = (int)read_raw(frame + protocol->count.offset, protocol->count.size, protocol->big_endian);
+        if (targets > protocol->max_targets) return -1;
+    }
+    return protocol->target_offset + targets * protocol->target_stride + checksum_size(protocol->checksum);
+}
+
+/**
+ * @brief 校验整帧
+ * @return 1 通过，0 失败
+ */
+int radar_protocol_verify(const radar_protocol_t *protocol, const unsigned char *frame, int length) {
+    int size = checksum_size(protocol->checksum);
+    const unsigned char *data = frame + protocol->checksum_start;
+    int n = length - size - protocol->checksum_start;
+    const unsigned char *expected = frame + length - size;
+
+    switch (protocol->checksum) {
+        case RADAR_CHECKSUM_XOR: {
+            unsigned char c = 0;
+            for (int i = 0; i < n; i++) c ^= data[i];
+            return c == expected[0];
+        }
+        case RADAR_CHECKSUM_SUM8: {
+            unsigned char c = 0;
+            for (int i = 0; i < n; i++) c = (unsigned char)(c + data[i]);
+            return c == expected[0];
+        }
+        case RADAR_CHECKSUM_CRC16:
+            return crc16_ccitt(data, n) == read_raw(expected, 2, protocol->big_endian);
+        default:
+            return 1;
+    }
+}
+
+/**
+ * @brief 一次解码帧内全部目标
+ * @return 解码出的目标数（不超过 max_detections）
+ */
+int radar_protocol_decode(const radar_protocol_t *protocol, const unsigned char *frame, int length,
+                          const struct timeval *arrival, radar_detection_t *detections, int max_detections) {
+    int targets = (length - protocol->target_offset - checksum_size(protocol->checksum)) / protocol->target_stride;
+    if (targets > max_detections) targets = max_detections;
+
+    const radar_field_t *fields = protocol->fields;
+    const unsigned char *record = frame + protocol->target_offset;
+    for (int i = 0; i < targets; i++, record += protocol->target_stride) {
+        radar_detection_t *d = &detections[i];
+        // 无 ID 字段的协议由 radar_scan_add 按扫描内序号编号（帧内序号跨帧重复）
+        d->target_id = fields[RADAR_FIELD_ID].size ? (int)field_value(protocol, &fields[RADAR_FIELD_ID], record)
+                                                    : RADAR_TARGET_ID_NONE;
+        d->range = field_value(protocol, &fields[RADAR_FIELD_RANGE], record);
+        d->angle = field_value(protocol, &fields[RADAR_FIELD_ANGLE], record);
+        d->velocity = field_value(protocol, &fields[RADAR_FIELD_VELOCITY], record);
+        d->rcs = field_value(protocol, &fields[RADAR_FIELD_RCS], record);
+        d->timestamp = *arrival;
+    }
+    return targets;
+}
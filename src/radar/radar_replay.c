@@ -0,0 +1,269 @@
+#define _GNU_SOURCE  // posix_openpt / ptsname
+#include "mec_radar.h"
+#include <fcntl.h>
+
+/**
+ * @file radar_replay.c
+ * @brief 雷达原始字节流录制与回放
+ *
+ * 录制：串口每次 read 得到的字节块连同到达时间追加写入文件，
+ * 格式见 RADAR_RECORD_MAGIC（小端定长头 + 原始字节，无额外编码）。
+ * 回放支持三种方式：
+ * - PTY：创建伪终端，按录制节拍写入主端，雷达按普通串口打开从端，
+ *   覆盖完整的串口/epoll 路径；
+ * - 实时：按录制节拍直接注入解析器；
+ * - 尽快：不做节拍直接注入解析器，检测时间戳沿用录制的到达时间
+ *   （扫描划分与现场一致），用于离线测量解析与流水线吞吐。
+ */
+
+#define REPLAY_RECORD_HEADER  10
+#define REPLAY_MAX_CHUNK      65535
+#define REPLAY_SLEEP_STEP_US  100000   // 休眠分段，保证停止请求及时响应
+
+struct radar_replay_t {
+    radar_replay_mode_t mode;
+    int loop;
+    char path[256];
+    FILE *file;
+    int pty_master;
+    char device[64];                 // PTY 从端路径
+    radar_processor_t *processor;
+    thread_context_t thread_ctx;
+    volatile int finished;
+    long bytes;
+    long records;
+    unsigned char buf[REPLAY_MAX_CHUNK];
+};
+
+FILE* radar_record_open(const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        LOG_ERROR("Radar Record: Failed to open %s: %s", path, strerror(errno));
+        return NULL;
+    }
+    setvbuf(file, NULL, _IOFBF, 1 << 16);
+    fwrite(RADAR_RECORD_MAGIC, 1, 8, file);
+    LOG_INFO("Radar Record: Capturing raw bytes to %s", path);
+    return file;
+}
+
+int radar_record_write(FILE *file, const struct timeval *arrival, const unsigned char *data, size_t len) {
+    if (!file || !arrival || !data) return -1;
+
+    uint64_t us = (uint64_t)arrival->tv_sec * 1000000ULL + (uint64_t)arrival->tv_usec;
+    while (len > 0) {
+        size_t chunk = len > REPLAY_MAX_CHUNK ? REPLAY_MAX_CHUNK : len;
+        unsigned char header[REPLAY_RECORD_HEADER];
+        for (int i = 0; i < 8; i++) header[i] = (unsigned char)(us >> (8 * i));
+        header[8] = (unsigned char)(chunk & 0xFF);
+        header[9] = (unsigned char)(chunk >> 8);
+        if (fwrite(header, 1, sizeof(header), file) != sizeof(header) ||
+            fwrite(data, 1, chunk, file) != chunk) {
+            return -1;
+        }
+        data += chunk;
+        len -= chunk;
+    }
+    return 0;
+}
+
+void radar_record_close(FILE *file) {
+    if (file) fclose(file);
+}
+
+radar_replay_t* radar_replay_create(const char *path, radar_replay_mode_t mode, int loop) {
+    if (!path) return NULL;
+
+    radar_replay_t *replay = mec_calloc(1, sizeof(radar_replay_t));
+    if (!replay) return NULL;
+    replay->mode = mode;
+    replay->loop = loop;
+    replay->pty_master = -1;
+    strncpy(replay->path, path, sizeof(replay->path) - 1);
+
+    char magic[8];
+    replay->file = fopen(path, "rb");
+    if (!replay->file || fread(magic, 1, 8, replay->file) != 8 || memcmp(magic, RADAR_RECORD_MAGIC, 8) != 0) {
+        LOG_ERROR("Radar Replay: %s is not a radar capture", path);
+        radar_replay_destroy(replay);
+        return NULL;
+    }
+
+    if (mode == RADAR_REPLAY_PTY) {
+        replay->pty_master = posix_openpt(O_RDWR | O_NOCTTY);
+        const char *slave = NULL;
+        if (replay->pty_master < 0 || grantpt(replay->pty_master) != 0 ||
+            unlockpt(replay->pty_master) != 0 || !(slave = ptsname(replay->pty_master))) {
+            LOG_ERROR("Radar Replay: Failed to create pseudo-terminal: %s", strerror(errno));
+            radar_replay_destroy(replay);
+            return NULL;
+        }
+        strncpy(replay->device, slave, sizeof(replay->device) - 1);
+    }
+
+    LOG_INFO("Radar Replay: %s (%s%s)%s%s", path,
+             mode == RADAR_REPLAY_PTY ? "pty" : (mode == RADAR_REPLAY_REALTIME ? "realtime" : "fast"),
+             loop ? ", loop" : "", replay->device[0] ? " on " : "", replay->device);
+    return replay;
+}
+
+void radar_replay_destroy(radar_replay_t *replay) {
+    if (!replay) return;
+    radar_replay_stop(replay);
+    if (replay->file) fclose(replay->file);
+    if (replay->pty_master >= 0) close(replay->pty_master);
+    mec_free(replay);
+}
+
+const char* radar_replay_device(const radar_replay_t *replay) {
+    return (replay && replay->device[0]) ? replay->device : NULL;
+}
+
+int radar_replay_finished(const radar_replay_t *replay) {
+    return replay && replay->finished;
+}
+
+// 读取下一条记录到 buf；返回 0 成功，1 文件结束，-1 格式错误
+static int read_record(radar_replay_t *replay, uint64_t *us, size_t *len) {
+    unsigned char header[REPLAY_RECORD_HEADER];
+    size_t n = fread(header, 1, sizeof(header), replay->file);
+    if (n == 0 && feof(replay->file)) return 1;
+    if (n != sizeof(header)) return -1;
+
+    *us = 0;
+    for (int i = 0; i < 8; i++) *us |= (uint64_t)header[i] << (8 * i);
+    *len = (size_t)header[8] | ((size_t)header[9] << 8);
+    return fread(replay->buf, 1, *len, replay->file) == *len ? 0 : -1;
+}
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 等到 due（单调时钟，微秒）
+ *
+ * 直接注入模式下，等待期间到期的扫描照常发布（与 I/O 线程的超时发布一致）。
+ * @return 0 到期，-1 收到停止请求
+ */
+static int wait_until(radar_replay_t *replay, uint64_t due) {
+    for (;;) {
+        if (!replay->thread_ctx.running) return -1;
+        uint64_t now = monotonic_us();
+        if (now >= due) return 0;
+
+        uint64_t wait = due - now;
+        if (replay->mode == RADAR_REPLAY_REALTIME) {
+            struct timeval tv;
+            gettimeofday(&tv, NULL);
+            long scan_ms = radar_scan_timeout_ms(replay->processor, &tv);
+            if (scan_ms == 0) {
+                radar_scan_flush(replay->processor);
+                continue;
+            }
+            if (scan_ms > 0 && (uint64_t)scan_ms * 1000 < wait) wait = (uint64_t)scan_ms * 1000;
+        }
+        if (wait > REPLAY_SLEEP_STEP_US) wait = REPLAY_SLEEP_STEP_US;
+        usleep((useconds_t)wait);
+    }
+}
+
+static int write_all(int fd, const unsigned char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static void* radar_replay_thread(void *arg) {
+    radar_replay_t *replay = (radar_replay_t*)arg;
+    radar_processor_t *processor = replay->processor;
+    uint64_t first_us = 0, start_us = 0;
+    int first = 1;
+    uint64_t began = monotonic_us();
+    long frames_before = processor ? processor->frames_decoded : 0;
+
+    while (replay->thread_ctx.running) {
+        uint64_t us;
+        size_t len;
+        int r = read_record(replay, &us, &len);
+        if (r == 1 && replay->loop) {
+            fseek(replay->file, 8, SEEK_SET);
+            first = 1;
+            continue;
+        }
+        if (r != 0) {
+            if (r < 0) LOG_ERROR("Radar Replay: Truncated record in %s", replay->path);
+            break;
+        }
+
+        if (first) {
+            first_us = us;
+            start_us = monotonic_us();
+            first = 0;
+        }
+        if (replay->mode != RADAR_REPLAY_FAST && wait_until(replay, start_us + (us - first_us)) != 0) break;
+
+        if (replay->mode == RADAR_REPLAY_PTY) {
+            if (write_all(replay->pty_master, replay->buf, len) != 0) {
+                LOG_ERROR("Radar Replay: Write to %s failed: %s", replay->device, strerror(errno));
+                break;
+            }
+        } else {
+            struct timeval arrival;
+            if (replay->mode == RADAR_REPLAY_FAST) {
+                arrival.tv_sec = (time_t)(us / 1000000ULL);
+                arrival.tv_usec = (suseconds_t)(us % 1000000ULL);
+            } else {
+                gettimeofday(&arrival, NULL);
+            }
+            radar_processor_feed(processor, replay->buf, len, &arrival);
+        }
+        replay->bytes += (long)len;
+        replay->records++;
+    }
+
+    double seconds = (monotonic_us() - began) / 1e6;
+    if (replay->mode != RADAR_REPLAY_PTY) {
+        radar_scan_flush(processor);
+        long frames = processor->frames_decoded - frames_before;
+        LOG_INFO("Radar Replay: %ld bytes, %ld frames, %ld scans in %.3f s (%.0f frames/s, %.1f MB/s)",
+                 replay->bytes, frames, processor->scans_published, seconds,
+                 seconds > 0 ? frames / seconds : 0.0, seconds > 0 ? replay->bytes / seconds / 1e6 : 0.0);
+    } else {
+        LOG_INFO("Radar Replay: %ld bytes written to %s in %.3f s", replay->bytes, replay->device, seconds);
+    }
+    replay->finished = 1;
+    return NULL;
+}
+
+/**
+ * @brief 启动回放线程
+ *
+ * 直接注入模式下 processor 完全由回放线程驱动，不能同时注册到 I/O 线程；
+ * PTY 模式下 processor 应已打开 radar_replay_device() 返回的从端。
+ */
+int radar_replay_start(radar_replay_t *replay, radar_processor_t *processor) {
+    if (!replay || !processor) return -1;
+    replay->processor = processor;
+    replay->finished = 0;
+    if (thread_create(&replay->thread_ctx, radar_replay_thread, replay) != 0) {
+        LOG_ERROR("Radar Replay: Failed to start replay thread");
+        replay->thread_ctx.running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void radar_replay_stop(radar_replay_t *replay) {
+    if (!replay || !replay->thread_ctx.running) return;
+    thread_destroy(&replay->thread_ctx);
+}
@@ -0,0 +1,266 @@
+#include "video_runtime.h"
+#include <new>
+
+/**
+ * @file video_detector.cpp
+ * @brief 目标检测器接口及实现
+ *
+ * 占位后端输出固定的演示目标；DNN 后端用 OpenCV DNN（CPU）加载本地
+ * ONNX 模型（YOLOv5/YOLOv8 输出格式），一次前向可处理多路相机的帧。
+ * 输入 blob 按 batch_size 一次性分配，预处理直接写入 blob 内存，
+ * 输出 Mat 与 NMS 临时数组在多次调用间复用。
+ * 检测器实例不可并发调用，每个工作线程持有一个。
+ */
+
+struct video_detector_t {
+    video_detector_config_t config;
+
+    cv::dnn::Net net;
+    std::vector<std::string> output_names;
+    cv::Mat blob;                         // batch_size x 3 x H x W，CV_32F
+    cv::Mat resized;                      // 预处理临时缓冲区（尺寸不变时不重新分配）
+    cv::Mat letterbox;
+    cv::Mat input_f32;
+    std::vector<cv::Mat> planes;          // 指向 blob 内存的通道视图
+    std::vector<cv::Mat> outputs;
+    std::vector<float> scales;            // 每帧的缩放与填充，用于还原坐标
+    std::vector<int> pad_x;
+    std::vector<int> pad_y;
+    std::vector<cv::Rect> boxes;
+    std::vector<float> scores;
+    std::vector<int> classes;
+    std::vector<int> keep;
+};
+
+extern "C" {
+
+void video_detector_config_load(config_t *config, video_detector_config_t *out) {
+    memset(out, 0, sizeof(*out));
+    const char *backend = config_get_string(config, "video.detector.backend", "placeholder");
+    out->backend = strcmp(backend, "dnn") == 0 ? VIDEO_DETECTOR_DNN : VIDEO_DETECTOR_PLACEHOLDER;
+    strncpy(out->model_path, config_get_string(config, "video.detector.model", ""), sizeof(out->model_path) - 1);
+    out->input_width = config_get_int(config, "video.detector.input_width", 640);
+    out->input_height = config_get_int(config, "video.detector.input_height", 640);
+    out->batch_size = config_get_int(config, "video.detector.batch_size", 4);
+    out->score_threshold = (float)config_get_double(config, "video.detector.score_threshold", 0.4);
+    out->nms_threshold = (float)config_get_double(config, "video.detector.nms_threshold", 0.45);
+}
+
+video_detector_t* video_detector_create(const video_detector_config_t *config) {
+    if (!config) return NULL;
+
+    video_detector_t *detector = new (std::nothrow) video_detector_t();
+    if (!detector) return NULL;
+    detector->config = *config;
+    if (detector->config.batch_size < 1) detector->config.batch_size = 1;
+    if (detector->config.backend == VIDEO_DETECTOR_PLACEHOLDER) return detector;
+
+    const video_detector_config_t *cfg = &detector->config;
+    if (cfg->input_width <= 0 || cfg->input_height <= 0) {
+        LOG_ERROR("Detector: Invalid input size %dx%d", cfg->input_width, cfg->input_height);
+        delete detector;
+        return NULL;
+    }
+
+    try {
+        detector->net = cv::dnn::readNetFromONNX(cfg->model_path);
+        if (detector->net.empty()) {
+            LOG_ERROR("Detector: Failed to load model %s", cfg->model_path);
+            delete detector;
+            return NULL;
+        }
+        detector->net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        detector->net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        detector->output_names = detector->net.getUnconnectedOutLayersNames();
+
+        int shape[4] = {cfg->batch_size, 3, cfg->input_height, cfg->input_width};
+        detector->blob.create(4, shape, CV_32F);
+        detector->letterbox.create(cfg->input_height, cfg->input_width, CV_8UC3);
+        detector->planes.resize(3);
+    } catch (const cv::Exception &e) {
+        LOG_ERROR("Detector: Failed to load model %s: %s", cfg->model_path, e.what());
+        delete detector;
+        return NULL;
+    }
+
+    detector->scales.resize(cfg->batch_size);
+    detector->pad_x.resize(cfg->batch_size);
+    detector->pad_y.resize(cfg->batch_size);
+    LOG_INFO("Detector: Loaded %s (input %dx%d, batch %d)", cfg->model_path,
+             cfg->input_width, cfg->input_height, cfg->batch_size);
+    return detector;
+}
+
+void video_detector_destroy(video_detector_t *detector) {
+    delete detector;
+}
+
+int video_detector_batch_size(const video_detector_t *detector) {
+    return detector ? detector->config.batch_size : 1;
+}
+
+// 占位后端：固定的演示目标（ID 由跟踪器分配）
+static int placeholder_detect(track_list_t *tracks) {
+    target_track_t track;
+    memset(&track, 0, sizeof(track));
+
+    for (int i = 0; i < 3; i++) {
+        track.type = TARGET_VEHICLE;
+        track.position.latitude = 0.3 + i * 0.2;  // Normalized coordinates
+        track.position.longitude = 0.4 + i * 0.1;
+        track.position.altitude = 0.0;
+        track.velocity = 10.0 + i * 5.0;
+        track.heading = 45.0 + i * 30.0;
+        track.confidence = 0.8 + i * 0.05;
+        track_list_add(tracks, &track);
+    }
+    return 0;
+}
+
+// 等比缩放 + 灰边填充，结果按 RGB 平面写入 blob 的第 index 帧
+static void preprocess(video_detector_t *detector, const video_detect_input_t *input, int index) {
+    const video_detector_config_t *cfg = &detector->config;
+    const cv::Mat &frame = *(const cv::Mat *)input->frame;
+    cv::Mat roi = frame(cv::Rect(input->roi_x, input->roi_y, input->roi_width, input->roi_height));
+
+    float scale = std::min((float)cfg->input_width / roi.cols, (float)cfg->input_height / roi.rows);
+    int w = std::max(1, (int)(roi.cols * scale));
+    int h = std::max(1, (int)(roi.rows * scale));
+    int px = (cfg->input_width - w) / 2;
+    int py = (cfg->input_height - h) / 2;
+    detector->scales[index] = scale;
+    detector->pad_x[index] = px;
+    detector->pad_y[index] = py;
+
+    cv::resize(roi, detector->resized, cv::Size(w, h), 0, 0, cv::INTER_LINEAR);
+    detector->letterbox.setTo(cv::Scalar(114, 114, 114));
+    cv::Mat content = detector->letterbox(cv::Rect(px, py, w, h));
+    detector->resized.copyTo(content);
+    detector->letterbox.convertTo(detector->input_f32, CV_32F, 1.0 / 255.0);
+
+    // split 对尺寸/类型一致的输出不重新分配，直接写入 blob；BGR -> RGB
+    for (int c = 0; c < 3; c++) {
+        detector->planes[c] = cv::Mat(cfg->input_height, cfg->input_width, CV_32F,
+                                      detector->blob.ptr<float>(index, 2 - c));
+    }
+    cv::split(detector->input_f32, detector->planes);
+}
+
+// COCO 类别 -> 目标类型（-1 表示忽略）
+static int coco_to_target_type(int class_id) {
+    switch (class_id) {
+        case 0: return TARGET_PEDESTRIAN;
+        case 1: case 3: return TARGET_NON_VEHICLE;
+        case 2: case 5: case 7: return TARGET_VEHICLE;
+        default: return -1;
+    }
+}
+
+/**
+ * @brief 解析第 index 帧的输出并写入航迹列表（坐标为 ROI 内归一化值）
+ *
+ * 支持 YOLOv5 [N, anchors, 5 + C] 与 YOLOv8 [N, 4 + C, anchors] 两种布局。
+ * 目标位置取检测框底边中点（接地点），与地面透视标定一致。
+ */
+static void postprocess(video_detector_t *detector, const video_detect_input_t *input, int index,
+                        track_list_t *tracks) {
+    const cv::Mat &out = detector->outputs[0];
+    int dim1 = out.size[1], dim2 = out.size[2];
+    int transposed = dim1 < dim2;                 // YOLOv8：属性在前
+    int anchors = transposed ? dim2 : dim1;
+    int attrs = transposed ? dim1 : dim2;
+    int has_objectness = !transposed;
+    int class_offset = has_objectness ? 5 : 4;
+    const float *data = out.ptr<float>(index);
+
+    detector->boxes.clear();
+    detector->scores.clear();
+    detector->classes.clear();
+
+    float scale = detector->scales[index];
+    int px = detector->pad_x[index], py = detector->pad_y[index];
+    // 按布局取第 a 个候选的第 k 个属性
+    #define ATTR(k) (transposed ? data[(k) * anchors + a] : data[a * attrs + (k)])
+    for (int a = 0; a < anchors; a++) {
+        float objectness = has_objectness ? ATTR(4) : 1.0f;
+        if (objectness < detector->config.score_threshold) continue;
+
+        int best = -1;
+        float best_score = 0;
+        for (int k = class_offset; k < attrs; k++) {
+            float s = ATTR(k);
+            if (s > best_score) {
+                best_score = s;
+                best = k - class_offset;
+            }
+        }
+        float score = best_score * objectness;
+        if (best < 0 || score < detector->config.score_threshold || coco_to_target_type(best) < 0) continue;
+
+        float cx = (ATTR(0) - px) / scale;
+        float cy = (ATTR(1) - py) / scale;
+        float w = ATTR(2) / scale;
+        float h = ATTR(3) / scale;
+        detector->boxes.push_back(cv::Rect((int)(cx - w / 2), (int)(cy - h / 2), (int)w, (int)h));
+        detector->scores.push_back(score);
+        detector->classes.push_back(best);
+    }
+    #undef ATTR
+
+    cv::dnn::NMSBoxes(detector->boxes, detector->scores, detector->config.score_threshold,
+                      detector->config.nms_threshold, detector->keep);
+
+    target_track_t track;
+    memset(&track, 0, sizeof(track));
+    for (size_t k = 0; k < detector->keep.size(); k++) {
+        int i = detector->keep[k];
+        const cv::Rect &box = detector->boxes[i];
+        track.type = (target_type_t)coco_to_target_type(detector->classes[i]);
+        track.position.longitude = (box.x + box.width * 0.5) / input->roi_width;
+        track.position.latitude = (double)(box.y + box.height) / input->roi_height;
+        track.confidence = detector->scores[i];
+        track_list_add(tracks, &track);
+    }
+}
+
+/**
+ * @brief 对一批帧做检测，inputs[i] 的结果追加到 outputs[i]
+ *
+ * count 超过 batch_size 时按 batch_size 分多次前向。
+ * @return 0 成功，-1 失败（outputs 内容未定义）
+ */
+int video_detector_detect(video_detector_t *detector, const video_detect_input_t *inputs,
+                          track_list_t **outputs, int count) {
+    if (!detector || !inputs || !outputs || count <= 0) return -1;
+
+    if (detector->config.backend == VIDEO_DETECTOR_PLACEHOLDER) {
+        for (int i = 0; i < count; i++) placeholder_detect(outputs[i]);
+        return 0;
+    }
+
+    const video_detector_config_t *cfg = &detector->config;
+    try {
+        for (int start = 0; start < count; start += cfg->batch_size) {
+            int n = std::min(cfg->batch_size, count - start);
+            for (int i = 0; i < n; i++) preprocess(detector, &inputs[start + i], i);
+
+            // 不足一批时只取 blob 前 n 帧的视图，不拷贝
+            int shape[4] = {n, 3, cfg->input_height, cfg->input_width};
+            cv::Mat batch(4, shape, CV_32F, detector->blob.ptr<float>());
+            detector->net.setInput(batch);
+            detector->net.forward(detector->outputs, detector->output_names);
+            if (detector->outputs.empty() || detector->outputs[0].dims != 3) {
+                LOG_ERROR("Detector: Unexpected output layout");
+                return -1;
+            }
+
+            for (int i = 0; i < n; i++) postprocess(detector, &inputs[start + i], i, outputs[start + i]);
+        }
+    } catch (const cv::Exception &e) {
+        LOG_ERROR("Detector: Inference failed: %s", e.what());
+        return -1;
+    }
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,108 @@
+#include "mec_video.h"
+
+/**
+ * @file video_frame.c
+ * @brief 定长、对齐、带引用计数的帧缓冲池
+ *
+ * 每路相机一个池，按首帧分辨率一次性分配 count 帧像素内存
+ * （单块 64 字节对齐，行跨度按 64 字节对齐）。各处理阶段只传递
+ * video_frame_t 引用，像素内存以 cv::Mat 头的方式直接访问，不拷贝。
+ * 引用计数归零时帧回到自由链表；池被销毁后，最后一帧归还时才真正释放。
+ */
+
+#define FRAME_ALIGN 64
+
+static void frame_pool_free(video_frame_pool_t *pool) {
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->storage);
+    mec_free(pool->frames);
+    mec_free(pool);
+}
+
+video_frame_pool_t* video_frame_pool_create(int count, int width, int height, int channels) {
+    if (count <= 0 || width <= 0 || height <= 0 || channels <= 0) return NULL;
+
+    video_frame_pool_t *pool = mec_calloc(1, sizeof(video_frame_pool_t));
+    if (!pool) return NULL;
+
+    pool->count = count;
+    pool->width = width;
+    pool->height = height;
+    pool->channels = channels;
+    pool->step = ((size_t)width * channels + FRAME_ALIGN - 1) & ~(size_t)(FRAME_ALIGN - 1);
+    pool->frame_bytes = pool->step * height;
+    pthread_mutex_init(&pool->lock, NULL);
+
+    pool->frames = mec_calloc(count, sizeof(video_frame_t));
+    if (!pool->frames || posix_memalign((void **)&pool->storage, FRAME_ALIGN, pool->frame_bytes * count) != 0) {
+        pool->storage = NULL;
+        frame_pool_free(pool);
+        return NULL;
+    }
+
+    for (int i = count - 1; i >= 0; i--) {
+        video_frame_t *frame = &pool->frames[i];
+        frame->data = pool->storage + pool->frame_bytes * i;
+        frame->width = width;
+        frame->height = height;
+        frame->channels = channels;
+        frame->step = pool->step;
+        frame->pool = pool;
+        frame->next_free = pool->free_list;
+        pool->free_list = frame;
+    }
+
+    LOG_INFO("Frame Pool: %d x %dx%dx%d frames (%.1f MB)", count, width, height, channels,
+             pool->frame_bytes * count / (1024.0 * 1024.0));
+    return pool;
+}
+
+void video_frame_pool_destroy(video_frame_pool_t *pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->retired = 1;
+    int outstanding = pool->outstanding;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (outstanding == 0) frame_pool_free(pool);
+}
+
+video_frame_t* video_frame_acquire(video_frame_pool_t *pool) {
+    if (!pool) return NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    video_frame_t *frame = pool->free_list;
+    if (frame) {
+        pool->free_list = frame->next_free;
+        frame->next_free = NULL;
+        frame->ref_count = 1;
+        pool->outstanding++;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return frame;
+}
+
+void video_frame_retain(video_frame_t *frame) {
+    if (!frame) return;
+    pthread_mutex_lock(&frame->pool->lock);
+    frame->ref_count++;
+    pthread_mutex_unlock(&frame->pool->lock);
+}
+
+void video_frame_release(video_frame_t *frame) {
+    if (!frame) return;
+
+    video_frame_pool_t *pool = frame->pool;
+    int destroy = 0;
+    pthread_mutex_lock(&pool->lock);
+    if (--frame->ref_count <= 0) {
+        frame->next_free = pool->free_list;
+        pool->free_list = frame;
+        pool->outstanding--;
+        destroy = pool->retired && pool->outstanding == 0;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (destroy) frame_pool_free(pool);
+}
@@ -0,0 +1,192 @@
+#include "mec_video.h"
+
+/**
+ * @file video_governor.c
+ * @brief 多相机负载调节器
+ *
+ * 周期性采样全局 CPU 占用（/proc/stat）与每路相机的捕获->发布时延。
+ * 过载时每周期对一路低优先级相机降一级：先降处理帧率，到下限后再
+ * 降输入分辨率；负载回落后按优先级从高到低逐级恢复。
+ * 优先级为 0 的关键相机（如路口进口道）始终保持满帧率、原分辨率。
+ * 每周期最多调整一路，配合高低两个阈值避免振荡。
+ */
+
+#define GOVERN_STEP 0.75
+
+void video_governor_config_load(config_t *config, video_governor_config_t *out) {
+    out->enabled = config_get_int(config, "video.governor.enabled", 0);
+    out->interval_ms = config_get_int(config, "video.governor.interval_ms", 1000);
+    out->cpu_high = config_get_double(config, "video.governor.cpu_high", 0.85);
+    out->cpu_low = config_get_double(config, "video.governor.cpu_low", 0.60);
+    out->latency_ms = config_get_double(config, "video.governor.latency_ms", 100.0);
+    if (out->interval_ms < 100) out->interval_ms = 100;
+}
+
+// 读取 /proc/stat 的总 CPU 计数，返回 0 成功
+static int read_cpu_times(unsigned long long *idle, unsigned long long *total) {
+    FILE *fp = fopen("/proc/stat", "r");
+    if (!fp) return -1;
+    unsigned long long v[8] = {0};
+    int n = fscanf(fp, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+                   &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]);
+    fclose(fp);
+    if (n < 4) return -1;
+    *idle = v[3] + v[4];
+    *total = 0;
+    for (int i = 0; i < 8; i++) *total += v[i];
+    return 0;
+}
+
+static int is_degraded(const video_processor_t *processor, const video_govern_state_t *state) {
+    return state->fps_limit < processor->config.fps || state->scale < 1.0;
+}
+
+// 降一级：先帧率后分辨率；已到下限返回 -1
+static int degrade(const video_processor_t *processor, video_govern_state_t *state) {
+    double min_fps = processor->config.min_fps > 0 ? processor->config.min_fps : 1;
+    if (state->fps_limit > min_fps) {
+        state->fps_limit = state->fps_limit * GOVERN_STEP;
+        if (state->fps_limit < min_fps) state->fps_limit = min_fps;
+        return 0;
+    }
+    if (state->scale > processor->config.min_scale) {
+        state->scale = state->scale * GOVERN_STEP;
+        if (state->scale < processor->config.min_scale) state->scale = processor->config.min_scale;
+        return 0;
+    }
+    return -1;
+}
+
+// 升一级：与降级顺序相反，先恢复分辨率再恢复帧率
+static void restore(const video_processor_t *processor, video_govern_state_t *state) {
+    if (state->scale < 1.0) {
+        state->scale = state->scale / GOVERN_STEP;
+        if (state->scale > 1.0) state->scale = 1.0;
+        return;
+    }
+    state->fps_limit = state->fps_limit / GOVERN_STEP;
+    if (state->fps_limit > processor->config.fps) state->fps_limit = processor->config.fps;
+}
+
+static void governor_step(video_governor_t *governor) {
+    video_pool_t *pool = governor->pool;
+    const video_governor_config_t *cfg = &governor->config;
+
+    unsigned long long idle, total;
+    if (read_cpu_times(&idle, &total) == 0) {
+        unsigned long long d_total = total - governor->prev_total;
+        if (governor->prev_total != 0 && d_total > 0) {
+            governor->cpu_busy = 1.0 - (double)(idle - governor->prev_idle) / d_total;
+        }
+        governor->prev_idle = idle;
+        governor->prev_total = total;
+    }
+
+    // 本周期各相机的平均时延
+    double latency[VIDEO_MAX_CAMERAS];
+    video_govern_state_t state[VIDEO_MAX_CAMERAS];
+    double worst_latency = 0;
+    for (int i = 0; i < pool->camera_count; i++) {
+        video_camera_stats_t st;
+        video_processor_get_stats(pool->cameras[i], &st);
+        video_processor_get_govern(pool->cameras[i], &state[i]);
+        long frames = st.frames_processed - governor->prev_frames[i];
+        latency[i] = frames > 0 ? (st.total_latency_ms - governor->prev_latency_ms[i]) / frames : 0;
+        governor->prev_frames[i] = st.frames_processed;
+        governor->prev_latency_ms[i] = st.total_latency_ms;
+        if (latency[i] > worst_latency) worst_latency = latency[i];
+    }
+
+    int pressure = governor->cpu_busy > cfg->cpu_high || worst_latency > cfg->latency_ms;
+    int relaxed = governor->cpu_busy < cfg->cpu_low && worst_latency < cfg->latency_ms * 0.5;
+
+    if (pressure) {
+        // 优先级数值最大者先降；同级取时延最高者
+        int victim = -1;
+        for (int i = 0; i < pool->camera_count; i++) {
+            const video_processor_t *p = pool->cameras[i];
+            if (p->config.priority <= 0) continue;
+            video_govern_state_t trial = state[i];
+            if (degrade(p, &trial) != 0) continue;
+            if (victim < 0 || p->config.priority > pool->cameras[victim]->config.priority ||
+                (p->config.priority == pool->cameras[victim]->config.priority && latency[i] > latency[victim])) {
+                victim = i;
+            }
+        }
+        if (victim >= 0) {
+            video_processor_t *p = pool->cameras[victim];
+            degrade(p, &state[victim]);
+            video_processor_set_govern(p, &state[victim]);
+            LOG_INFO("Governor: CPU %.0f%%, worst latency %.1f ms -> camera %d limited to %.1f fps, scale %.2f",
+                     governor->cpu_busy * 100, worst_latency, p->config.camera_id,
+                     state[victim].fps_limit, state[victim].scale);
+        }
+    } else if (relaxed) {
+        // 优先级数值最小者先恢复
+        int target = -1;
+        for (int i = 0; i < pool->camera_count; i++) {
+            const video_processor_t *p = pool->cameras[i];
+            if (!is_degraded(p, &state[i])) continue;
+            if (target < 0 || p->config.priority < pool->cameras[target]->config.priority) target = i;
+        }
+        if (target >= 0) {
+            video_processor_t *p = pool->cameras[target];
+            restore(p, &state[target]);
+            video_processor_set_govern(p, &state[target]);
+            LOG_INFO("Governor: CPU %.0f%% -> camera %d restored to %.1f fps, scale %.2f",
+                     governor->cpu_busy * 100, p->config.camera_id, state[target].fps_limit, state[target].scale);
+        }
+    }
+}
+
+void* video_governor_thread(void *arg) {
+    video_governor_t *governor = (video_governor_t*)arg;
+    if (!governor) return NULL;
+
+    thread_lock(&governor->thread_ctx);
+    while (governor->thread_ctx.running) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += governor->config.interval_ms / 1000;
+        deadline.tv_nsec += (governor->config.interval_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        // thread_destroy 会发信号，停止时无需等满一个周期
+        pthread_cond_timedwait(&governor->thread_ctx.cond, &governor->thread_ctx.mutex, &deadline);
+        if (!governor->thread_ctx.running) break;
+
+        thread_unlock(&governor->thread_ctx);
+        governor_step(governor);
+        thread_lock(&governor->thread_ctx);
+    }
+    thread_unlock(&governor->thread_ctx);
+    return NULL;
+}
+
+int video_governor_start(video_governor_t *governor, video_pool_t *pool) {
+    if (!governor || !pool) return -1;
+    if (!governor->config.enabled) return 0;
+
+    governor->pool = pool;
+    governor->cpu_busy = 0;
+    governor->prev_total = 0;
+    read_cpu_times(&governor->prev_idle, &governor->prev_total);
+    memset(governor->prev_frames, 0, sizeof(governor->prev_frames));
+    memset(governor->prev_latency_ms, 0, sizeof(governor->prev_latency_ms));
+
+    if (thread_create(&governor->thread_ctx, video_governor_thread, governor) != 0) {
+        LOG_ERROR("Governor: Failed to start");
+        return -1;
+    }
+    LOG_INFO("Governor: Started (interval %d ms, CPU %.0f%%/%.0f%%, latency budget %.0f ms)",
+             governor->config.interval_ms, governor->config.cpu_low * 100,
+             governor->config.cpu_high * 100, governor->config.latency_ms);
+    return 0;
+}
+
+void video_governor_stop(video_governor_t *governor) {
+    if (!governor || !governor->thread_ctx.running) return;
+    thread_destroy(&governor->thread_ctx);
+}
@@ -0,0 +1,441 @@
+#include "video_runtime.h"
+
+/**
+ * @file video_pool.cpp
+ * @brief 多相机视频处理池
+ *
+ * 每路相机一个捕获线程（只做解码），检测/跟踪/坐标转换由一组
+ * 共享工作线程完成，工作线程数默认等于在线 CPU 核数。
+ * 捕获线程把有新帧的相机放入就绪队列，工作线程按 FIFO 一次取出
+ * 至多 batch_size 路相机，合并为一次检测前向；
+ * 同一相机同一时刻只会被一个工作线程处理。
+ */
+
+extern "C" {
+
+// 生成相机配置键：多相机模式为 "video.<i>.<name>"，兼容模式为 "video.<name>"
+static const char* camera_key(char *buf, size_t size, int index, int legacy, const char *name) {
+    if (legacy) snprintf(buf, size, "video.%s", name);
+    else snprintf(buf, size, "video.%d.%s", index, name);
+    return buf;
+}
+
+// 标定与检测区域的配置前缀：兼容模式沿用顶层的 "transform.*" / "region.*"
+static const char* calib_key(char *buf, size_t size, int index, int legacy, const char *name) {
+    if (legacy) snprintf(buf, size, "%s", name);
+    else snprintf(buf, size, "video.%d.%s", index, name);
+    return buf;
+}
+
+// 相机级配置优先，未配置时回退到全局 "video.<name>"
+static const char* camera_setting(config_t *config, int index, int legacy, const char *name) {
+    char key[128];
+    const char *value = config_get_string(config, camera_key(key, sizeof(key), index, legacy, name), NULL);
+    if (value || legacy) return value;
+    snprintf(key, sizeof(key), "video.%s", name);
+    return config_get_string(config, key, NULL);
+}
+
+static void load_motion_config(config_t *config, int index, int legacy, video_motion_config_t *motion) {
+    const char *v;
+    motion->enabled = (v = camera_setting(config, index, legacy, "motion.enabled")) ? atoi(v) : 0;
+    motion->width = (v = camera_setting(config, index, legacy, "motion.width")) ? atoi(v) : 160;
+    motion->tiles_x = (v = camera_setting(config, index, legacy, "motion.tiles_x")) ? atoi(v) : 8;
+    motion->tiles_y = (v = camera_setting(config, index, legacy, "motion.tiles_y")) ? atoi(v) : 6;
+    motion->pixel_threshold = (v = camera_setting(config, index, legacy, "motion.pixel_threshold")) ? atoi(v) : 25;
+    motion->tile_ratio = (v = camera_setting(config, index, legacy, "motion.tile_ratio")) ? atof(v) : 0.01;
+    motion->refresh_frames = (v = camera_setting(config, index, legacy, "motion.refresh_frames")) ? atoi(v) : 50;
+}
+
+static void load_camera_calibration(config_t *config, int index, int legacy, video_processor_t *processor) {
+    char key[128];
+
+    if (config_get_string(config, calib_key(key, sizeof(key), index, legacy, "transform.matrix_00"), NULL)) {
+        perspective_transform_t transform;
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) {
+                char name[64];
+                snprintf(name, sizeof(name), "transform.matrix_%d%d", r, c);
+                transform.matrix[r * 3 + c] = config_get_double(config, calib_key(key, sizeof(key), index, legacy, name),
+                                                                (r == c) ? 1.0 : 0.0);
+            }
+        }
+        transform.calibrated = 1;
+        // 标定原点：相机级 transform.origin_* 优先，否则标定在站点 ENU 坐标系下（site.origin_*）
+        if (config_get_string(config, calib_key(key, sizeof(key), index, legacy, "transform.origin_lat"), NULL)) {
+            wgs84_coord_t origin;
+            origin.latitude = config_get_double(config, calib_key(key, sizeof(key), index, legacy, "transform.origin_lat"), 0.0);
+            origin.longitude = config_get_double(config, calib_key(key, sizeof(key), index, legacy, "transform.origin_lon"), 0.0);
+            origin.altitude = config_get_double(config, calib_key(key, sizeof(key), index, legacy, "transform.origin_alt"), 0.0);
+            geo_site_init(&transform.site, &origin);
+        } else {
+            geo_site_load(config, &transform.site);
+        }
+        transform.grid_cell = config_get_int(config, calib_key(key, sizeof(key), index, legacy, "transform.grid_cell"), 16);
+        video_processor_set_transform(processor, &transform);
+    }
+
+    for (int r = 0; r < 4; r++) {
+        char name[64];
+        snprintf(name, sizeof(name), "region.%d.enabled", r);
+        if (!config_get_int(config, calib_key(key, sizeof(key), index, legacy, name), 0)) continue;
+
+        detection_region_t region;
+        memset(&region, 0, sizeof(region));
+        region.enabled = 1;
+        snprintf(name, sizeof(name), "region.%d.point_count", r);
+        region.point_count = config_get_int(config, calib_key(key, sizeof(key), index, legacy, name), 0);
+        if (region.point_count > 10) region.point_count = 10;
+        for (int p = 0; p < region.point_count; p++) {
+            snprintf(name, sizeof(name), "region.%d.point_%d_x", r, p);
+            region.points[p].x = config_get_int(config, calib_key(key, sizeof(key), index, legacy, name), 0);
+            snprintf(name, sizeof(name), "region.%d.point_%d_y", r, p);
+            region.points[p].y = config_get_int(config, calib_key(key, sizeof(key), index, legacy, name), 0);
+        }
+        video_processor_add_region(processor, &region);
+    }
+}
+
+video_pool_t* video_pool_create(config_t *config, mec_queue_t *target_queue) {
+    video_pool_t *pool = (video_pool_t*)mec_calloc(1, sizeof(video_pool_t));
+    if (!pool) return NULL;
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+
+    // 未配置 video.camera_count 时按单相机兼容模式读取 "video.*"
+    int count = config_get_int(config, "video.camera_count", 0);
+    int legacy = (count <= 0);
+    if (legacy) count = 1;
+    if (count > VIDEO_MAX_CAMERAS) {
+        LOG_WARN("Video Pool: %d cameras configured, limiting to %d", count, VIDEO_MAX_CAMERAS);
+        count = VIDEO_MAX_CAMERAS;
+    }
+
+    video_detector_config_load(config, &pool->detector_config);
+    video_governor_config_load(config, &pool->governor.config);
+
+    char key[128];
+    for (int i = 0; i < count; i++) {
+        video_config_t cfg;
+        memset(&cfg, 0, sizeof(cfg));
+        strncpy(cfg.rtsp_url, config_get_string(config, camera_key(key, sizeof(key), i, legacy, "rtsp_url"),
+                "rtsp://192.168.1.100:554/stream"), sizeof(cfg.rtsp_url) - 1);
+        cfg.width = config_get_int(config, camera_key(key, sizeof(key), i, legacy, "width"), 1920);
+        cfg.height = config_get_int(config, camera_key(key, sizeof(key), i, legacy, "height"), 1080);
+        cfg.fps = config_get_int(config, camera_key(key, sizeof(key), i, legacy, "fps"), 30);
+        cfg.camera_id = config_get_int(config, camera_key(key, sizeof(key), i, legacy, "camera_id"), i + 1);
+        cfg.track_gate = config_get_double(config, "video.tracker.gate", VIDEO_TRACK_GATE);
+        cfg.track_max_misses = config_get_int(config, "video.tracker.max_misses", VIDEO_TRACK_MAX_MISSES);
+        cfg.track_max_coast_ms = config_get_int(config, "video.tracker.max_coast_ms", VIDEO_TRACK_MAX_COAST_MS);
+        load_motion_config(config, i, legacy, &cfg.motion);
+        const char *v;
+        cfg.frame_pool_size = (v = camera_setting(config, i, legacy, "frame_pool_size")) ? atoi(v) : VIDEO_FRAME_POOL_SIZE;
+        cfg.priority = (v = camera_setting(config, i, legacy, "priority")) ? atoi(v) : 1;
+        cfg.min_fps = (v = camera_setting(config, i, legacy, "min_fps")) ? atoi(v) : 5;
+        cfg.min_scale = (v = camera_setting(config, i, legacy, "min_scale")) ? atof(v) : 0.5;
+        const char *source = config_get_string(config, camera_key(key, sizeof(key), i, legacy, "source"), "rtsp");
+        cfg.source_type = strcmp(source, "file") == 0 ? VIDEO_SOURCE_FILE :
+                          (strcmp(source, "images") == 0 ? VIDEO_SOURCE_IMAGES : VIDEO_SOURCE_RTSP);
+        strncpy(cfg.source_path, config_get_string(config, camera_key(key, sizeof(key), i, legacy, "source_path"), ""),
+                sizeof(cfg.source_path) - 1);
+        cfg.playback = strcmp(config_get_string(config, camera_key(key, sizeof(key), i, legacy, "playback"), "realtime"),
+                              "fast") == 0 ? VIDEO_PLAYBACK_FAST : VIDEO_PLAYBACK_REALTIME;
+        cfg.loop = config_get_int(config, camera_key(key, sizeof(key), i, legacy, "loop"), 0);
+        cfg.target_queue = target_queue;
+
+        video_processor_t *processor = video_processor_create(&cfg);
+        if (!processor) {
+            LOG_ERROR("Video Pool: Failed to create camera %d", i);
+            video_pool_destroy(pool);
+            return NULL;
+        }
+        processor->runtime->pool = pool;
+        processor->runtime->pool_index = i;
+        load_camera_calibration(config, i, legacy, processor);
+        pool->cameras[pool->camera_count++] = processor;
+    }
+
+    // 工作线程数：默认 min(在线核数, 相机数)；显式配置为 batch 时（仅 DNN）按批大小
+    // 均分相机，前向内部已多线程。任何情况下不超过相机数（同一相机的帧串行处理）
+    const char *worker_setting = config_get_string(config, "video.worker_threads", "0");
+    int workers = atoi(worker_setting);
+    int per_batch = strcmp(worker_setting, "batch") == 0;
+    if (per_batch && pool->detector_config.backend == VIDEO_DETECTOR_DNN) {
+        int batch = pool->detector_config.batch_size > 0 ? pool->detector_config.batch_size : 1;
+        workers = (pool->camera_count + batch - 1) / batch;
+    } else if (workers <= 0) {
+        if (per_batch) LOG_WARN("Video Pool: video.worker_threads=batch requires the dnn backend, using defaults");
+        int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        workers = pool->camera_count < cores ? pool->camera_count : cores;
+    }
+    if (workers > pool->camera_count) workers = pool->camera_count;
+    if (workers < 1) workers = 1;
+    pool->worker_count = workers;
+
+    LOG_INFO("Video Pool: %d cameras, %d shared workers", pool->camera_count, pool->worker_count);
+    return pool;
+}
+
+void video_pool_destroy(video_pool_t *pool) {
+    if (!pool) return;
+    for (int i = 0; i < pool->camera_count; i++) {
+        video_processor_destroy(pool->cameras[i]);
+    }
+    if (pool->workers) {
+        for (int i = 0; i < pool->worker_count; i++) video_detector_destroy(pool->workers[i].detector);
+    }
+    mec_free(pool->workers);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->cond);
+    mec_free(pool);
+}
+
+int video_pool_start(video_pool_t *pool) {
+    if (!pool) return -1;
+
+    pool->workers = (video_worker_t*)mec_calloc(pool->worker_count, sizeof(video_worker_t));
+    if (!pool->workers) return -1;
+
+    // 每个工作线程一个检测器（网络实例不可并发前向）
+    for (int i = 0; i < pool->worker_count; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        pool->workers[i].detector = video_detector_create(&pool->detector_config);
+        if (!pool->workers[i].detector) {
+            LOG_ERROR("Video Pool: Failed to create detector for worker %d", i);
+            return -1;
+        }
+    }
+
+    pool->running = 1;
+    for (int i = 0; i < pool->worker_count; i++) {
+        if (thread_create(&pool->workers[i].thread_ctx, video_worker_thread, &pool->workers[i]) != 0) {
+            LOG_ERROR("Video Pool: Failed to start worker %d", i);
+            for (int j = i; j < pool->worker_count; j++) {
+                video_detector_destroy(pool->workers[j].detector);
+                pool->workers[j].detector = NULL;
+            }
+            pool->worker_count = i;
+            video_pool_stop(pool);
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < pool->camera_count; i++) {
+        video_processor_t *processor = pool->cameras[i];
+        if (thread_create(&processor->thread_ctx, video_capture_thread, processor) != 0) {
+            LOG_ERROR("Video Pool: Failed to start capture for camera %d", processor->config.camera_id);
+            video_pool_stop(pool);
+            return -1;
+        }
+        LOG_INFO("Started capture for camera %d (%s)", processor->config.camera_id,
+                 processor->config.source_type == VIDEO_SOURCE_RTSP ? processor->config.rtsp_url : processor->config.source_path);
+    }
+
+    if (video_governor_start(&pool->governor, pool) != 0) {
+        video_pool_stop(pool);
+        return -1;
+    }
+    return 0;
+}
+
+void video_pool_stop(video_pool_t *pool) {
+    if (!pool || !pool->running) return;
+
+    video_governor_stop(&pool->governor);
+
+    // 先停捕获线程，再唤醒并回收工作线程
+    for (int i = 0; i < pool->camera_count; i++) {
+        if (pool->cameras[i]->thread_ctx.running) thread_destroy(&pool->cameras[i]->thread_ctx);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->running = 0;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->worker_count; i++) {
+        thread_destroy(&pool->workers[i].thread_ctx);
+    }
+    LOG_INFO("Video Pool: Stopped");
+}
+
+void video_pool_enqueue(video_pool_t *pool, int camera_index) {
+    pthread_mutex_lock(&pool->lock);
+    int tail = (pool->ready_head + pool->ready_count) % VIDEO_MAX_CAMERAS;
+    pool->ready[tail] = camera_index;
+    pool->ready_count++;
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief 处理一批相机：逐路取最新帧并准备，合并为一次检测，再逐路发布
+ */
+static void process_batch(video_worker_t *worker, const int *camera_indices, int count) {
+    video_pool_t *pool = worker->pool;
+    video_processor_t *batch[VIDEO_MAX_CAMERAS];
+    video_frame_t *frames[VIDEO_MAX_CAMERAS];
+    cv::Mat mats[VIDEO_MAX_CAMERAS];          // 池帧的 Mat 头，不拷贝像素
+    video_detect_input_t inputs[VIDEO_MAX_CAMERAS];
+    track_list_t *outputs[VIDEO_MAX_CAMERAS];
+    int n = 0;
+
+    for (int i = 0; i < count; i++) {
+        video_processor_t *processor = pool->cameras[camera_indices[i]];
+        video_runtime_t *rt = processor->runtime;
+
+        pthread_mutex_lock(&rt->lock);
+        video_frame_t *frame = video_ring_take_locked(rt);
+        if (!frame) {
+            rt->queued = 0;
+            pthread_mutex_unlock(&rt->lock);
+            continue;
+        }
+        pthread_mutex_unlock(&rt->lock);
+
+        mats[n] = video_frame_mat(frame);
+        outputs[n] = track_list_ring_acquire(&processor->output_ring);   // 同一相机同一时刻只在一个工作线程中
+        if (!outputs[n] || video_frame_prepare(processor, &mats[n], &inputs[n]) != 0) {
+            if (outputs[n]) track_list_release(outputs[n]);
+            video_frame_release(frame);
+            pthread_mutex_lock(&rt->lock);
+            rt->queued = 0;
+            pthread_mutex_unlock(&rt->lock);
+            continue;
+        }
+        batch[n] = processor;
+        frames[n] = frame;
+        n++;
+    }
+    if (n == 0) return;
+
+    // 运动门控跳过的相机不进入检测批次
+    video_detect_input_t detect_inputs[VIDEO_MAX_CAMERAS];
+    track_list_t *detect_outputs[VIDEO_MAX_CAMERAS];
+    int detect_count = 0;
+    for (int i = 0; i < n; i++) {
+        if (inputs[i].skip) continue;
+        detect_inputs[detect_count] = inputs[i];
+        detect_outputs[detect_count++] = outputs[i];
+    }
+    if (detect_count > 0) {
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        if (video_detector_detect(worker->detector, detect_inputs, detect_outputs, detect_count) != 0) {
+            for (int i = 0; i < detect_count; i++) track_list_clear(detect_outputs[i]);
+        }
+        // 批次耗时均摊到参与的相机
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double share = video_elapsed_ms(&t0, &t1) / detect_count;
+        for (int i = 0; i < n; i++) {
+            if (!inputs[i].skip) video_stats_add_stage(batch[i], VIDEO_STAGE_DETECT, share);
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        video_processor_t *processor = batch[i];
+        video_runtime_t *rt = processor->runtime;
+        video_frame_publish(processor, &inputs[i], outputs[i], &frames[i]->capture_time);
+        video_frame_release(frames[i]);
+
+        // 处理期间又来了新帧：直接重新排队，否则释放“排队中”标记
+        pthread_mutex_lock(&rt->lock);
+        if (rt->latest) video_pool_enqueue(pool, rt->pool_index);
+        else rt->queued = 0;
+        pthread_mutex_unlock(&rt->lock);
+    }
+}
+
+void* video_worker_thread(void *arg) {
+    video_worker_t *worker = (video_worker_t*)arg;
+    video_pool_t *pool = worker->pool;
+    int batch_size = video_detector_batch_size(worker->detector);
+    if (batch_size > VIDEO_MAX_CAMERAS) batch_size = VIDEO_MAX_CAMERAS;
+    int camera_indices[VIDEO_MAX_CAMERAS];
+
+    while (1) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->running && pool->ready_count == 0) {
+            pthread_cond_wait(&pool->cond, &pool->lock);
+        }
+        if (!pool->running) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        // 取走当前已就绪的相机（不等待凑满一批，避免增加时延）
+        int count = 0;
+        while (pool->ready_count > 0 && count < batch_size) {
+            camera_indices[count++] = pool->ready[pool->ready_head];
+            pool->ready_head = (pool->ready_head + 1) % VIDEO_MAX_CAMERAS;
+            pool->ready_count--;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        process_batch(worker, camera_indices, count);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 输出每路相机的帧率、时延与丢帧统计，并开启新的统计窗口
+ */
+void video_pool_report(video_pool_t *pool) {
+    if (!pool) return;
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    for (int i = 0; i < pool->camera_count; i++) {
+        video_processor_t *processor = pool->cameras[i];
+        video_camera_stats_t *st = &processor->stats;
+
+        pthread_mutex_lock(&processor->runtime->lock);
+        double elapsed = (now.tv_sec - st->window_start.tv_sec) +
+                         (now.tv_usec - st->window_start.tv_usec) / 1000000.0;
+        if (elapsed > 0) st->fps = st->window_frames / elapsed;
+        st->avg_latency_ms = st->window_frames > 0 ? st->window_latency_ms / st->window_frames : 0;
+        // 各阶段单独运行时可达的帧率（帧数 / 该阶段累计耗时）
+        for (int s = 0; s < VIDEO_STAGE_COUNT; s++) {
+            long frames = (s == VIDEO_STAGE_DECODE) ? st->window_decoded : st->window_frames;
+            st->stage_fps[s] = st->window_stage_ms[s] > 0 ? frames * 1000.0 / st->window_stage_ms[s] : 0;
+            st->window_stage_ms[s] = 0;
+        }
+        st->window_decoded = 0;
+        video_camera_stats_t snapshot = *st;
+        video_govern_state_t govern_snapshot = processor->govern;
+        st->window_frames = 0;
+        st->window_latency_ms = 0;
+        st->max_latency_ms = 0;
+        st->window_start = now;
+        pthread_mutex_unlock(&processor->runtime->lock);
+
+        LOG_INFO("VIDEO: Camera %d | FPS: %.2f | Latency avg %.2f ms, max %.2f ms | Captured: %ld | Dropped: %ld | "
+                 "Skipped: %ld | Cropped: %ld | Throttled: %ld | Limit %.1f fps, scale %.2f",
+                 processor->config.camera_id, snapshot.fps, snapshot.avg_latency_ms,
+                 snapshot.max_latency_ms, snapshot.frames_captured, snapshot.frames_dropped,
+                 snapshot.frames_skipped, snapshot.frames_cropped, snapshot.frames_throttled,
+                 govern_snapshot.fps_limit, govern_snapshot.scale);
+        LOG_INFO("VIDEO: Camera %d | Stage FPS: decode %.1f, prepare %.1f, detect %.1f, publish %.1f",
+                 processor->config.camera_id, snapshot.stage_fps[VIDEO_STAGE_DECODE],
+                 snapshot.stage_fps[VIDEO_STAGE_PREPARE], snapshot.stage_fps[VIDEO_STAGE_DETECT],
+                 snapshot.stage_fps[VIDEO_STAGE_PUBLISH]);
+    }
+}
+
+/**
+ * @brief 所有相机的离线源均已播放完毕（且没有待处理的帧）
+ */
+int video_pool_finished(video_pool_t *pool) {
+    if (!pool || pool->camera_count == 0) return 0;
+    for (int i = 0; i < pool->camera_count; i++) {
+        video_runtime_t *rt = pool->cameras[i]->runtime;
+        pthread_mutex_lock(&rt->lock);
+        int done = pool->cameras[i]->stats.end_of_stream && !rt->latest && !rt->queued;
+        pthread_mutex_unlock(&rt->lock);
+        if (!done) return 0;
+    }
+    return 1;
+}
+
+} // extern "C"
@@ -1,5 +1,5 @@
-#include "mec_video.h"
-#include <opencv2/opencv.hpp>
+#include "video_runtime.h"
+#include <new>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -13,14 +13,50 @@ video_processor_t* video_processor_create(const video_config_t *config) {
     if (!processor) return NULL;
     
     processor->config = *config;
-    processor->transform.calibrated = 0;
+    memset(&processor->thread_ctx, 0, sizeof(processor->thread_ctx));
+    memset(&processor->process_ctx, 0, sizeof(processor->process_ctx));
+    memset(&processor->transform, 0, sizeof(processor->transform));
+    processor->grid = NULL;
+    processor->detector = NULL;
+    processor->govern.fps_limit = config->fps;
+    processor->govern.scale = 1.0;
     processor->region_count = 0;
-    processor->output_tracks = track_list_create(100);
+    track_list_ring_init(&processor->output_ring, 100);
+    processor->output_tracks = track_list_ring_acquire(&processor->output_ring);
+    memset(&processor->stats, 0, sizeof(processor->stats));
+    gettimeofday(&processor->stats.window_start, NULL);
+    processor->runtime = new (std::nothrow) video_runtime_t();
+    processor->tracker = video_tracker_create(
+        config->track_gate > 0 ? config->track_gate : VIDEO_TRACK_GATE,
+        config->track_max_misses > 0 ? config->track_max_misses : VIDEO_TRACK_MAX_MISSES,
+        config->track_max_coast_ms > 0 ? config->track_max_coast_ms : VIDEO_TRACK_MAX_COAST_MS);
     
-    if (!processor->output_tracks) {
+    if (!processor->output_tracks || !processor->runtime || !processor->tracker) {
+        if (processor->output_tracks) track_list_release(processor->output_tracks);
+        track_list_ring_destroy(&processor->output_ring);
+        video_tracker_destroy(processor->tracker);
+        delete processor->runtime;
         mec_free(processor);
         return NULL;
     }
+
+    video_runtime_t *rt = processor->runtime;
+    pthread_mutex_init(&rt->lock, NULL);
+    pthread_cond_init(&rt->frame_ready, NULL);
+    pthread_cond_init(&rt->frame_taken, NULL);
+    rt->frames = NULL;
+    rt->latest = NULL;
+    rt->queued = 0;
+    rt->pool_index = -1;
+    rt->pool = NULL;
+    rt->region_dirty = 1;
+    rt->region_active = 0;
+    rt->region_frame_width = 0;
+    rt->region_frame_height = 0;
+    rt->motion_valid = 0;
+    rt->last_commit.tv_sec = 0;
+    rt->last_commit.tv_usec = 0;
+    rt->motion_since_full = 0;
     
     LOG_INFO("Created video processor for camera %d", config->camera_id);
     return processor;
@@ -31,14 +67,38 @@ void video_processor_destroy(video_processor_t *processor) {
     
     video_processor_stop(processor);
     track_list_release(processor->output_tracks);
+    track_list_ring_destroy(&processor->output_ring);
+    video_tracker_destroy(processor->tracker);
+    video_frame_release(processor->runtime->latest);
+    video_frame_pool_destroy(processor->runtime->frames);
+    pthread_mutex_destroy(&processor->runtime->lock);
+    pthread_cond_destroy(&processor->runtime->frame_ready);
+    pthread_cond_destroy(&processor->runtime->frame_taken);
+    perspective_grid_destroy(processor->grid);
+    delete processor->runtime;
     mec_free(processor);
 }
 
 int video_processor_start(video_processor_t *processor) {
     if (!processor) return -1;
     
-    if (thread_create(&processor->thread_ctx, video_processing_thread, processor) != 0) {
+    // 独立模式自带检测器；线程池模式由工作线程持有
+    processor->detector = video_detector_create(&processor->config.detector);
+    if (!processor->detector) {
+        LOG_ERROR("Failed to create detector for camera %d", processor->config.camera_id);
+        return -1;
+    }
+
+    // 处理线程先启动，等待捕获线程发布的最新帧
+    if (thread_create(&processor->process_ctx, video_processing_thread, processor) != 0) {
         LOG_ERROR("Failed to start video processing thread");
+        video_detector_destroy(processor->detector);
+        processor->detector = NULL;
+        return -1;
+    }
+    if (thread_create(&processor->thread_ctx, video_capture_thread, processor) != 0) {
+        LOG_ERROR("Failed to start video capture thread");
+        video_processor_stop(processor);
         return -1;
     }
     
@@ -47,9 +107,19 @@ int video_processor_start(video_processor_t *processor) {
 }
 
 void video_processor_stop(video_processor_t *processor) {
-    if (!processor) return;
+    if (!processor || (!processor->thread_ctx.running && !processor->process_ctx.running)) return;
     
-    thread_destroy(&processor->thread_ctx);
+    if (processor->thread_ctx.running) thread_destroy(&processor->thread_ctx);
+    if (processor->process_ctx.running) {
+        // 唤醒阻塞在帧环上的处理线程
+        pthread_mutex_lock(&processor->runtime->lock);
+        processor->process_ctx.running = 0;
+        pthread_cond_broadcast(&processor->runtime->frame_ready);
+        pthread_mutex_unlock(&processor->runtime->lock);
+        thread_destroy(&processor->process_ctx);
+    }
+    video_detector_destroy(processor->detector);
+    processor->detector = NULL;
     LOG_INFO("Stopped video processor for camera %d", processor->config.camera_id);
 }
 
@@ -57,6 +127,8 @@ int video_processor_set_transform(video_processor_t *processor, const perspectiv
     if (!processor || !transform) return -1;
     
     processor->transform = *transform;
+    perspective_grid_destroy(processor->grid); // 标定变化后网格按需重建
+    processor->grid = NULL;
     LOG_INFO("Set perspective transform for camera %d", processor->config.camera_id);
     return 0;
 }
@@ -66,161 +138,503 @@ int video_processor_add_region(video_processor_t *processor, const detection_reg
     
     processor->regions[processor->region_count] = *region;
     processor->region_count++;
+    pthread_mutex_lock(&processor->runtime->lock);
+    processor->runtime->region_dirty = 1;
+    pthread_mutex_unlock(&processor->runtime->lock);
     LOG_INFO("Added detection region %d for camera %d", processor->region_count, processor->config.camera_id);
     return 0;
 }
 
+/**
+ * @brief 按帧尺寸栅格化检测区域（区域或分辨率变化时才重建）
+ *
+ * 未配置任何启用区域时掩码为空，ROI 为整帧。
+ * @param scale 帧相对原始分辨率的缩放（区域顶点以原始像素配置）
+ */
+static void video_update_region_mask(video_processor_t *processor, int width, int height, double scale) {
+    video_runtime_t *rt = processor->runtime;
+    if (!rt->region_dirty && rt->region_frame_width == width && rt->region_frame_height == height) return;
+
+    std::vector<std::vector<cv::Point> > polygons;
+    for (int r = 0; r < processor->region_count; r++) {
+        const detection_region_t *region = &processor->regions[r];
+        if (!region->enabled || region->point_count < 3) continue;
+        std::vector<cv::Point> poly;
+        for (int p = 0; p < region->point_count; p++) {
+            poly.push_back(cv::Point((int)(region->points[p].x * scale), (int)(region->points[p].y * scale)));
+        }
+        polygons.push_back(poly);
+    }
+
+    cv::Rect frame_rect(0, 0, width, height);
+    rt->region_active = !polygons.empty();
+    rt->region_dirty = 0;
+    rt->region_frame_width = width;
+    rt->region_frame_height = height;
+    if (!rt->region_active) {
+        rt->region_mask.release();
+        rt->region_roi = frame_rect;
+    } else {
+        rt->region_mask = cv::Mat::zeros(height, width, CV_8UC1);
+        cv::fillPoly(rt->region_mask, polygons, cv::Scalar(255));
+        cv::Rect roi = cv::boundingRect(polygons[0]);
+        for (size_t i = 1; i < polygons.size(); i++) roi = roi | cv::boundingRect(polygons[i]);
+        rt->region_roi = roi & frame_rect;
+        LOG_INFO("Camera %d: %d region(s) rasterized, ROI %dx%d at (%d,%d) = %.0f%% of frame",
+                 processor->config.camera_id, (int)polygons.size(), rt->region_roi.width, rt->region_roi.height,
+                 rt->region_roi.x, rt->region_roi.y, 100.0 * rt->region_roi.area() / frame_rect.area());
+    }
+}
+
+/**
+ * @brief 判断像素是否落在检测区域内（未配置区域时恒为真）
+ */
+int video_region_contains(const video_processor_t *processor, int x, int y) {
+    if (!processor) return 0;
+    const video_runtime_t *rt = processor->runtime;
+    if (!rt->region_active) return 1;
+    if (x < 0 || y < 0 || x >= rt->region_mask.cols || y >= rt->region_mask.rows) return 0;
+    return rt->region_mask.ptr(y)[x] != 0;
+}
+
+void video_processor_get_govern(video_processor_t *processor, video_govern_state_t *state) {
+    if (!processor || !state) return;
+    pthread_mutex_lock(&processor->runtime->lock);
+    *state = processor->govern;
+    pthread_mutex_unlock(&processor->runtime->lock);
+}
+
+void video_processor_set_govern(video_processor_t *processor, const video_govern_state_t *state) {
+    if (!processor || !state) return;
+    pthread_mutex_lock(&processor->runtime->lock);
+    processor->govern = *state;
+    pthread_mutex_unlock(&processor->runtime->lock);
+}
+
 track_list_t* video_processor_get_tracks(video_processor_t *processor) {
     if (!processor) return NULL;
     return processor->output_tracks;
 }
 
-int transform_image_to_wgs84(const perspective_transform_t *transform, 
-                           const image_coord_t *image_coord, 
-                           wgs84_coord_t *wgs84_coord) {
-    if (!transform || !image_coord || !wgs84_coord || !transform->calibrated) {
-        return -1;
+void video_processor_get_stats(video_processor_t *processor, video_camera_stats_t *stats) {
+    if (!processor || !stats) return;
+    pthread_mutex_lock(&processor->runtime->lock);
+    *stats = processor->stats;
+    pthread_mutex_unlock(&processor->runtime->lock);
+}
+
+/**
+ * @brief 运动门控：缩小灰度帧差分，按网格统计每块的变化像素
+ *
+ * 只统计与检测区域外接矩形相交的网格块。无活动块时置 skip；
+ * 否则把 ROI 收缩到活动块的外接矩形（外扩一块）。每 refresh_frames
+ * 帧强制整帧检测一次，避免静止目标长期未被确认。
+ */
+static void video_motion_gate(video_processor_t *processor, const cv::Mat &frame, video_detect_input_t *input) {
+    const video_motion_config_t *cfg = &processor->config.motion;
+    video_runtime_t *rt = processor->runtime;
+    if (!cfg->enabled || cfg->width <= 0 || cfg->tiles_x <= 0 || cfg->tiles_y <= 0 || frame.empty()) return;
+
+    int sw = std::min(cfg->width, frame.cols);
+    int sh = std::max(1, frame.rows * sw / frame.cols);
+    cv::resize(frame, rt->motion_small, cv::Size(sw, sh), 0, 0, cv::INTER_AREA);
+    if (rt->motion_small.channels() == 3) cv::cvtColor(rt->motion_small, rt->motion_gray, cv::COLOR_BGR2GRAY);
+    else rt->motion_small.copyTo(rt->motion_gray);
+
+    if (!rt->motion_valid || rt->motion_prev.cols != sw || rt->motion_prev.rows != sh) {
+        cv::swap(rt->motion_gray, rt->motion_prev);
+        rt->motion_valid = 1;
+        rt->motion_since_full = 0;
+        return;
     }
-    
-    double x = image_coord->x;
-    double y = image_coord->y;
-    
-    // Apply perspective transformation matrix
-    double w = transform->matrix[6] * x + transform->matrix[7] * y + transform->matrix[8];
-    if (fabs(w) < 1e-10) return -1;
-    
-    double world_x = (transform->matrix[0] * x + transform->matrix[1] * y + transform->matrix[2]) / w;
-    double world_y = (transform->matrix[3] * x + transform->matrix[4] * y + transform->matrix[5]) / w;
-    
-    // Convert to WGS84 (simplified - in practice would need proper projection)
-    wgs84_coord->latitude = world_y;
-    wgs84_coord->longitude = world_x;
-    wgs84_coord->altitude = 0.0;
-    
+
+    cv::absdiff(rt->motion_gray, rt->motion_prev, rt->motion_diff);
+    cv::threshold(rt->motion_diff, rt->motion_diff, cfg->pixel_threshold, 255, cv::THRESH_BINARY);
+    cv::swap(rt->motion_gray, rt->motion_prev);
+
+    if (++rt->motion_since_full >= cfg->refresh_frames && cfg->refresh_frames > 0) {
+        rt->motion_since_full = 0;
+        return;
+    }
+
+    // 检测 ROI 映射到缩小帧
+    double fx = (double)sw / frame.cols, fy = (double)sh / frame.rows;
+    cv::Rect roi(input->roi_x, input->roi_y, input->roi_width, input->roi_height);
+    cv::Rect small_roi((int)(roi.x * fx), (int)(roi.y * fy),
+                       std::max(1, (int)ceil(roi.width * fx)), std::max(1, (int)ceil(roi.height * fy)));
+    int tile_w = (sw + cfg->tiles_x - 1) / cfg->tiles_x;
+    int tile_h = (sh + cfg->tiles_y - 1) / cfg->tiles_y;
+
+    cv::Rect active;
+    for (int ty = 0; ty < cfg->tiles_y; ty++) {
+        for (int tx = 0; tx < cfg->tiles_x; tx++) {
+            cv::Rect tile = cv::Rect(tx * tile_w, ty * tile_h, tile_w, tile_h) & cv::Rect(0, 0, sw, sh);
+            if (tile.empty() || (tile & small_roi).empty()) continue;
+            int changed = cv::countNonZero(rt->motion_diff(tile));
+            if (changed < cfg->tile_ratio * tile.area()) continue;
+            // 外扩一块，覆盖跨块边界的目标
+            cv::Rect grown(tile.x - tile_w, tile.y - tile_h, tile.width + 2 * tile_w, tile.height + 2 * tile_h);
+            active = active.empty() ? grown : (active | grown);
+        }
+    }
+
+    if (active.empty()) {
+        input->skip = 1;
+        return;
+    }
+
+    cv::Rect crop((int)(active.x / fx), (int)(active.y / fy),
+                  (int)ceil(active.width / fx), (int)ceil(active.height / fy));
+    crop = crop & roi;
+    if (!crop.empty() && crop.area() < roi.area()) {
+        input->roi_x = crop.x;
+        input->roi_y = crop.y;
+        input->roi_width = crop.width;
+        input->roi_height = crop.height;
+        input->cropped = 1;
+    }
+}
+
+/**
+ * @brief 检测前准备：按帧尺寸更新区域掩码，填写检测输入（区域外接矩形）
+ *
+ * 只对检测区域的外接矩形做检测（ROI 视图，不拷贝像素）。
+ */
+int video_frame_prepare(video_processor_t *processor, const void *frame_data, video_detect_input_t *input) {
+    if (!processor || !frame_data || !input) return -1;
+    const cv::Mat &native = *(const cv::Mat *)frame_data;
+    video_runtime_t *rt = processor->runtime;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    pthread_mutex_lock(&rt->lock);
+    double scale = processor->govern.scale;
+    pthread_mutex_unlock(&rt->lock);
+
+    // 调节器要求降分辨率时，后续检测、区域与运动门控都在缩小后的帧上进行
+    const cv::Mat *source = &native;
+    if (scale < 1.0 && !native.empty()) {
+        cv::Size size(std::max(1, (int)(native.cols * scale)), std::max(1, (int)(native.rows * scale)));
+        cv::resize(native, rt->scaled_frame, size, 0, 0, cv::INTER_AREA);
+        source = &rt->scaled_frame;
+    }
+    const cv::Mat &frame = *source;
+
+    pthread_mutex_lock(&rt->lock);
+    video_update_region_mask(processor, frame.cols, frame.rows, native.cols > 0 ? (double)frame.cols / native.cols : 1.0);
+    cv::Rect roi = rt->region_roi;
+    pthread_mutex_unlock(&rt->lock);
+
+    input->frame = source;
+    input->frame_width = native.cols;
+    input->frame_height = native.rows;
+    input->roi_x = roi.x;
+    input->roi_y = roi.y;
+    input->roi_width = roi.width;
+    input->roi_height = roi.height;
+    input->skip = 0;
+    input->cropped = 0;
+    video_motion_gate(processor, frame, input);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    video_stats_add_stage(processor, VIDEO_STAGE_PREPARE, video_elapsed_ms(&t0, &t1));
     return 0;
 }
 
+/**
+ * @brief 检测后处理：区域过滤 -> 跟踪 -> 坐标转换 -> 发布
+ *
+ * 每帧发布一个新的航迹列表，已推入队列的列表不会再被修改。
+ * 同一相机的帧必须串行调用（跟踪状态按相机保存）。
+ * @param tracks 检测结果（ROI 内归一化坐标），所有权转交给本函数
+ * @param capture_time 帧捕获时间，用于消息时间戳与时延统计
+ */
+int video_frame_publish(video_processor_t *processor, const video_detect_input_t *input,
+                        track_list_t *tracks, const struct timeval *capture_time) {
+    if (!processor || !input || !tracks || !capture_time) return -1;
+    const cv::Mat &frame = *(const cv::Mat *)input->frame;
+    video_runtime_t *rt = processor->runtime;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    // ROI 归一化坐标 -> 整帧归一化坐标，并剔除区域外的目标
+    int kept = 0;
+    for (int i = 0; i < tracks->count; i++) {
+        target_track_t *t = &tracks->tracks[i];
+        double px = input->roi_x + t->position.longitude * input->roi_width;
+        double py = input->roi_y + t->position.latitude * input->roi_height;
+        if (!video_region_contains(processor, (int)px, (int)py)) continue;
+        t->position.longitude = px / frame.cols;
+        t->position.latitude = py / frame.rows;
+        t->sensor_id = processor->config.camera_id;
+        t->timestamp = *capture_time;
+        tracks->tracks[kept++] = *t;
+    }
+    tracks->count = kept;
+
+    // 跳过的帧输出预测航迹；裁剪的帧只对裁剪区域内的轨迹计丢失
+    if (input->skip) {
+        video_tracker_predict(processor->tracker, tracks, capture_time);
+    } else {
+        video_norm_rect_t observed;
+        observed.x0 = (double)input->roi_x / frame.cols;
+        observed.y0 = (double)input->roi_y / frame.rows;
+        observed.x1 = (double)(input->roi_x + input->roi_width) / frame.cols;
+        observed.y1 = (double)(input->roi_y + input->roi_height) / frame.rows;
+        video_tracker_update(processor->tracker, tracks, &observed, capture_time);
+    }
+
+    // Transform coordinates if calibrated（整表批量转换，网格按帧尺寸构建一次）
+    // 标定基于原始分辨率，归一化坐标与缩放无关
+    if (processor->transform.calibrated) {
+        int width = input->frame_width, height = input->frame_height;
+        if (processor->transform.grid_cell > 0 &&
+            (!processor->grid || processor->grid->width != width || processor->grid->height != height)) {
+            perspective_grid_destroy(processor->grid);
+            processor->grid = perspective_grid_create(&processor->transform, width, height,
+                                                      processor->transform.grid_cell);
+        }
+        transform_tracks_to_wgs84(&processor->transform, processor->grid, tracks, width, height);
+    }
+
+    // 推送至异步队列（队列持有引用，零拷贝）
+    if (processor->config.target_queue) {
+        mec_msg_t msg;
+        msg.sensor_id = processor->config.camera_id;
+        msg.tracks = tracks;
+        msg.timestamp = *capture_time;
+        mec_queue_push(processor->config.target_queue, &msg);
+    }
+
+    thread_lock(&processor->thread_ctx);
+    track_list_t *previous_output = processor->output_tracks;
+    processor->output_tracks = tracks;
+    thread_unlock(&processor->thread_ctx);
+    track_list_release(previous_output);
+
+    // 时延统计：捕获 -> 发布
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    double latency_ms = (now.tv_sec - capture_time->tv_sec) * 1000.0 +
+                        (now.tv_usec - capture_time->tv_usec) / 1000.0;
+    pthread_mutex_lock(&rt->lock);
+    processor->stats.frames_processed++;
+    if (input->skip) processor->stats.frames_skipped++;
+    else if (input->cropped) processor->stats.frames_cropped++;
+    processor->stats.window_frames++;
+    processor->stats.window_latency_ms += latency_ms;
+    processor->stats.total_latency_ms += latency_ms;
+    processor->stats.window_stage_ms[VIDEO_STAGE_PUBLISH] += video_elapsed_ms(&t0, &t1);
+    if (latency_ms > processor->stats.max_latency_ms) processor->stats.max_latency_ms = latency_ms;
+    pthread_mutex_unlock(&rt->lock);
+
+    return 0;
+}
+
+/**
+ * @brief 处理单帧（批大小为 1）：准备 -> 检测（运动门控未跳过时）-> 发布
+ */
+int process_video_frame(video_processor_t *processor, video_detector_t *detector,
+                        const void *frame_data, const struct timeval *capture_time) {
+    video_detect_input_t input;
+    if (video_frame_prepare(processor, frame_data, &input) != 0) return -1;
+
+    track_list_t *tracks = track_list_ring_acquire(&processor->output_ring);
+    if (!tracks) return -1;
+    if (!input.skip) {
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        if (video_detector_detect(detector, &input, &tracks, 1) != 0) track_list_clear(tracks);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        video_stats_add_stage(processor, VIDEO_STAGE_DETECT, video_elapsed_ms(&t0, &t1));
+    }
+    return video_frame_publish(processor, &input, tracks, capture_time);
+}
+
+video_frame_t* video_ring_take_locked(video_runtime_t *rt) {
+    video_frame_t *frame = rt->latest;
+    rt->latest = NULL;
+    if (frame) pthread_cond_signal(&rt->frame_taken);
+    return frame;
+}
+
+void video_stats_add_stage(video_processor_t *processor, video_stage_t stage, double ms) {
+    pthread_mutex_lock(&processor->runtime->lock);
+    processor->stats.window_stage_ms[stage] += ms;
+    pthread_mutex_unlock(&processor->runtime->lock);
+}
+
+// 发布刚解码完成的帧（引用转移给 latest），覆盖未处理的旧帧
+static void video_ring_commit_locked(video_processor_t *processor, video_frame_t *frame) {
+    video_runtime_t *rt = processor->runtime;
+
+    processor->stats.frames_captured++;
+    if (rt->latest) {
+        processor->stats.frames_dropped++; // 旧帧未被处理即被覆盖
+        video_frame_release(rt->latest);
+    }
+    rt->latest = frame;
+}
+
+/**
+ * @brief 独立模式的处理线程：阻塞等待最新帧，处理完立即取下一帧
+ */
 void* video_processing_thread(void *arg) {
     video_processor_t *processor = (video_processor_t*)arg;
     if (!processor) return NULL;
-    
-    cv::VideoCapture cap;
-    
-    // Try to open RTSP stream
-    if (!cap.open(processor->config.rtsp_url)) {
-        LOG_ERROR("Failed to open RTSP stream: %s", processor->config.rtsp_url);
-        return NULL;
-    }
-    
-    cv::Mat frame;
-    track_list_t *previous_tracks = track_list_create(100);
-    
-    while (processor->thread_ctx.running) {
-        if (!cap.read(frame)) {
-            LOG_WARN("Failed to read frame from camera %d", processor->config.camera_id);
-            usleep(100000); // Wait 100ms before retry
+    video_runtime_t *rt = processor->runtime;
+
+    pthread_mutex_lock(&rt->lock);
+    while (processor->process_ctx.running) {
+        video_frame_t *frame = video_ring_take_locked(rt);
+        if (!frame) {
+            pthread_cond_wait(&rt->frame_ready, &rt->lock);
             continue;
         }
-        
-        // Process frame
-        thread_lock(&processor->thread_ctx);
-        track_list_clear(processor->output_tracks);
-        
-        if (detect_targets(frame.data, frame.cols, frame.rows, processor->output_tracks) == 0) {
-            track_targets(previous_tracks, processor->output_tracks);
-            
-            // Transform coordinates if calibrated
-            if (processor->transform.calibrated) {
-                for (int i = 0; i < processor->output_tracks->count; i++) {
-                    image_coord_t img_coord = {
-                        (int)(processor->output_tracks->tracks[i].position.longitude * frame.cols),
-                        (int)(processor->output_tracks->tracks[i].position.latitude * frame.rows)
-                    };
-                    
-                    wgs84_coord_t wgs84_coord;
-                    if (transform_image_to_wgs84(&processor->transform, &img_coord, &wgs84_coord) == 0) {
-                        processor->output_tracks->tracks[i].position = wgs84_coord;
-                    }
-                }
-            }
-        }
-        
-        // Copy current tracks to previous
-        track_list_clear(previous_tracks);
-        for (int i = 0; i < processor->output_tracks->count; i++) {
-            track_list_add(previous_tracks, &processor->output_tracks->tracks[i]);
-        }
+        pthread_mutex_unlock(&rt->lock);
 
-        // --- 新增：将结果推送至异步队列 ---
-        if (processor->config.target_queue) {
-            mec_msg_t msg;
-            msg.sensor_id = processor->config.camera_id;
-            msg.tracks = processor->output_tracks; // 队列内部会执行深拷贝
-            gettimeofday(&msg.timestamp, NULL);
-            mec_queue_push(processor->config.target_queue, &msg);
-        }
-        
-        thread_unlock(&processor->thread_ctx);
-        
-        usleep(33333); // ~30 FPS
+        cv::Mat mat = video_frame_mat(frame);
+        process_video_frame(processor, processor->detector, &mat, &frame->capture_time);
+        video_frame_release(frame);
+
+        pthread_mutex_lock(&rt->lock);
     }
-    
-    track_list_release(previous_tracks);
-    cap.release();
+    pthread_mutex_unlock(&rt->lock);
     return NULL;
 }
 
-int detect_targets(const void *frame_data, int width, int height, track_list_t *tracks) {
-    // Simplified target detection - in practice would use deep learning models
-    // This is a placeholder implementation
-    
-    static int target_id = 0;
-    target_track_t track;
-    
-    // Generate some dummy detections for demonstration
-    for (int i = 0; i < 3; i++) {
-        track.id = target_id++;
-        track.type = TARGET_VEHICLE;
-        track.position.latitude = 0.3 + i * 0.2;  // Normalized coordinates
-        track.position.longitude = 0.4 + i * 0.1;
-        track.position.altitude = 0.0;
-        track.velocity = 10.0 + i * 5.0;
-        track.heading = 45.0 + i * 30.0;
-        track.confidence = 0.8 + i * 0.05;
-        track.sensor_id = 1; // Video sensor
-        gettimeofday(&track.timestamp, NULL);
-        
-        track_list_add(tracks, &track);
+/**
+ * @brief 为当前解码结果准备池中的帧
+ *
+ * 正常情况下 cap.read 已直接写入池帧（dst 指向池内存），无需任何处理。
+ * 首帧或分辨率变化时 OpenCV 会另行分配 dst：按新尺寸重建帧池并拷贝
+ * 这一帧。池耗尽（下游仍持有全部帧）时返回 NULL，本帧丢弃。
+ */
+static video_frame_t* video_capture_adopt(video_processor_t *processor, video_frame_t *frame, const cv::Mat &dst) {
+    video_runtime_t *rt = processor->runtime;
+    if (frame && dst.data == frame->data) return frame;
+    video_frame_release(frame);
+    if (dst.empty() || dst.depth() != CV_8U) return NULL;
+
+    video_frame_pool_t *pool = rt->frames;
+    if (!pool || pool->width != dst.cols || pool->height != dst.rows || pool->channels != dst.channels()) {
+        int count = processor->config.frame_pool_size > 0 ? processor->config.frame_pool_size : VIDEO_FRAME_POOL_SIZE;
+        video_frame_pool_t *rebuilt = video_frame_pool_create(count, dst.cols, dst.rows, dst.channels());
+        if (!rebuilt) return NULL;
+        if (pool) {
+            LOG_WARN("Camera %d: Resolution changed to %dx%d, frame pool rebuilt",
+                     processor->config.camera_id, dst.cols, dst.rows);
+        }
+        video_frame_pool_destroy(pool); // 仍被下游引用的旧帧在释放后回收
+        rt->frames = rebuilt;
     }
-    
-    return 0;
+
+    frame = video_frame_acquire(rt->frames);
+    if (!frame) return NULL;
+    cv::Mat target = video_frame_mat(frame);
+    dst.copyTo(target);
+    return frame;
 }
 
-int track_targets(track_list_t *previous_tracks, track_list_t *current_tracks) {
-    // Simplified tracking - in practice would use Kalman filter or other algorithms
-    // This is a placeholder that just maintains track IDs
-    
-    for (int i = 0; i < current_tracks->count; i++) {
-        int matched = 0;
-        for (int j = 0; j < previous_tracks->count; j++) {
-            double dx = current_tracks->tracks[i].position.longitude - previous_tracks->tracks[j].position.longitude;
-            double dy = current_tracks->tracks[i].position.latitude - previous_tracks->tracks[j].position.latitude;
-            double distance = sqrt(dx*dx + dy*dy);
-            
-            if (distance < 0.1) { // Threshold for matching
-                current_tracks->tracks[i].id = previous_tracks->tracks[j].id;
-                matched = 1;
+/**
+ * @brief 捕获线程：持续从帧源解码到帧池中的空闲帧，不做任何处理
+ *
+ * 解码直接写入池帧的 cv::Mat 头（尺寸、类型一致时 OpenCV 不重新分配），
+ * 之后各阶段只传递帧引用。
+ * 线程池模式下提交相机到就绪队列，独立模式下唤醒本相机的处理线程。
+ */
+void* video_capture_thread(void *arg) {
+    video_processor_t *processor = (video_processor_t*)arg;
+    if (!processor) return NULL;
+    video_runtime_t *rt = processor->runtime;
+
+    video_source_t *source = video_source_open(&processor->config);
+    if (!source) {
+        LOG_ERROR("Failed to open video source for camera %d", processor->config.camera_id);
+        return NULL;
+    }
+    int fast = video_source_is_fast(source);
+
+    cv::Mat fallback; // 首帧、分辨率变化或帧池耗尽时的解码目标
+    while (processor->thread_ctx.running) {
+        video_frame_t *frame = video_frame_acquire(rt->frames);
+        cv::Mat dst = frame ? video_frame_mat(frame) : fallback;
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        int rc = video_source_read(source, dst);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        if (rc != 0) {
+            video_frame_release(frame);
+            if (rc > 0) {
+                LOG_INFO("Camera %d: End of stream", processor->config.camera_id);
+                pthread_mutex_lock(&rt->lock);
+                processor->stats.end_of_stream = 1;
+                pthread_mutex_unlock(&rt->lock);
                 break;
             }
+            LOG_WARN("Failed to read frame from camera %d", processor->config.camera_id);
+            usleep(100000); // Wait 100ms before retry
+            continue;
         }
-        
-        if (!matched) {
-            static int new_id = 1000;
-            current_tracks->tracks[i].id = new_id++;
+        if (!frame) fallback = dst;
+
+        struct timeval capture_time;
+        gettimeofday(&capture_time, NULL);
+
+        frame = video_capture_adopt(processor, frame, dst);
+        if (!frame) {
+            pthread_mutex_lock(&rt->lock);
+            processor->stats.frames_captured++;
+            processor->stats.frames_dropped++;
+            pthread_mutex_unlock(&rt->lock);
+            continue;
+        }
+        frame->capture_time = capture_time;
+
+        pthread_mutex_lock(&rt->lock);
+        processor->stats.window_decoded++;
+        processor->stats.window_stage_ms[VIDEO_STAGE_DECODE] += video_elapsed_ms(&t0, &t1);
+
+        // 尽快回放：等处理方取走上一帧再提交，保证逐帧无丢失
+        while (fast && rt->latest && processor->thread_ctx.running) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += 100000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&rt->frame_taken, &rt->lock, &deadline);
         }
+
+        // 调节器限帧：距上次提交不足一个帧间隔的帧直接丢弃（帧回到池中）
+        if (processor->govern.fps_limit > 0 && processor->govern.fps_limit < processor->config.fps) {
+            double since_ms = (capture_time.tv_sec - rt->last_commit.tv_sec) * 1000.0 +
+                              (capture_time.tv_usec - rt->last_commit.tv_usec) / 1000.0;
+            if (since_ms < 1000.0 / processor->govern.fps_limit) {
+                processor->stats.frames_captured++;
+                processor->stats.frames_throttled++;
+                pthread_mutex_unlock(&rt->lock);
+                video_frame_release(frame);
+                continue;
+            }
+        }
+        rt->last_commit = capture_time;
+        video_ring_commit_locked(processor, frame);
+        if (rt->pool) {
+            if (!rt->queued) {
+                rt->queued = 1;
+                video_pool_enqueue(rt->pool, rt->pool_index);
+            }
+        } else {
+            pthread_cond_signal(&rt->frame_ready);
+        }
+        pthread_mutex_unlock(&rt->lock);
     }
-    
-    return 0;
+
+    video_source_close(source);
+    return NULL;
 }
 
 } // extern "C"
\ No newline at end of file
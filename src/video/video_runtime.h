@@ -0,0 +1,74 @@
+#ifndef MEC_VIDEO_RUNTIME_H
+#define MEC_VIDEO_RUNTIME_H
+
+// 公共头文件为纯 C 声明，需以 C 链接方式引入
+extern "C" {
+#include "mec_video.h"
+}
+#include <opencv2/opencv.hpp>
+
+// 以 cv::Mat 头包装池中的帧（不拷贝、不接管内存）
+static inline cv::Mat video_frame_mat(const video_frame_t *frame) {
+    return cv::Mat(frame->height, frame->width, CV_8UC(frame->channels), frame->data, frame->step);
+}
+
+/**
+ * @brief 视频处理器的 C++ 侧运行时状态（对 C 接口不可见）
+ *
+ * 捕获线程从本相机的帧池取一帧，直接解码到池内存，完成后在锁内
+ * 发布为 latest（转移引用）；处理方总是取走最新的完整帧，处理完释放
+ * 引用。未被取走就被覆盖的旧帧计入 frames_dropped。
+ * 因此无论检测耗时多长，排队等待的帧最多只有一帧。
+ */
+struct video_runtime_t {
+    pthread_mutex_t lock;          // 保护 latest、queued、stats 与 govern
+    pthread_cond_t frame_ready;    // 独立模式：通知处理线程有新帧
+    pthread_cond_t frame_taken;    // 尽快回放：捕获等待处理方取走上一帧
+    video_frame_pool_t *frames;    // 按首帧分辨率创建，仅捕获线程重建
+    video_frame_t *latest;         // 最新的完整帧（持有一个引用，NULL 表示没有新帧）
+    int queued;                    // 已提交给线程池（排队或处理中）
+    int pool_index;                // 在线程池中的相机序号（独立模式为 -1）
+    video_pool_t *pool;
+
+    // 检测区域：多边形按帧尺寸栅格化一次，点查询为 O(1)
+    cv::Mat region_mask;           // CV_8U，非 0 表示属于某个启用的区域
+    cv::Rect region_roi;           // 所有区域并集的外接矩形（检测前裁剪）
+    int region_dirty;              // 区域变化后需重新栅格化
+    int region_active;             // 至少有一个启用的区域（否则不过滤）
+    int region_frame_width;        // 掩码对应的帧尺寸（可能是降分辨率后的尺寸）
+    int region_frame_height;
+
+    // 负载调节：帧率上限在捕获侧执行，分辨率缩放在检测前执行
+    struct timeval last_commit;    // 上次提交给处理方的帧时间
+    cv::Mat scaled_frame;          // 降分辨率后的帧（仅处理路径访问）
+
+    // 运动门控：缩小后的灰度帧差分（仅处理路径访问，同一相机串行）
+    cv::Mat motion_small;          // 缩小后的彩色帧
+    cv::Mat motion_gray;           // 当前灰度帧
+    cv::Mat motion_prev;           // 上一帧灰度帧
+    cv::Mat motion_diff;
+    int motion_valid;              // motion_prev 有效
+    int motion_since_full;         // 距上次整帧检测的帧数
+};
+
+// 帧源（RTSP / 文件 / 图像目录）
+struct video_source_t;
+video_source_t* video_source_open(const video_config_t *config);
+void video_source_close(video_source_t *src);
+int video_source_read(video_source_t *src, cv::Mat &dst);
+int video_source_is_fast(const video_source_t *src);
+
+// 累加某一阶段的耗时（毫秒）
+extern "C" void video_stats_add_stage(video_processor_t *processor, video_stage_t stage, double ms);
+
+static inline double video_elapsed_ms(const struct timespec *from, const struct timespec *to) {
+    return (to->tv_sec - from->tv_sec) * 1000.0 + (to->tv_nsec - from->tv_nsec) / 1000000.0;
+}
+
+// 取走最新帧（引用转移给调用方，调用方需持有 rt->lock）
+extern "C" video_frame_t* video_ring_take_locked(video_runtime_t *rt);
+
+// 线程池内部接口：捕获线程提交有新帧的相机
+extern "C" void video_pool_enqueue(video_pool_t *pool, int camera_index);
+
+#endif // MEC_VIDEO_RUNTIME_H
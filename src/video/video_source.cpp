@@ -0,0 +1,153 @@
+#include "video_runtime.h"
+#include <new>
+#include <algorithm>
+#include <cctype>
+
+/**
+ * @file video_source.cpp
+ * @brief 视频输入源：RTSP 流、本地视频文件、图像目录
+ *
+ * 离线源（文件/图像目录）支持两种回放方式：
+ * - 实时：按源帧率节拍输出，行为与在线相机一致；
+ * - 尽快：不做节拍，配合捕获侧的背压（见 video_capture_thread）逐帧无丢失地
+ *   送入处理流水线，用于测量整条流水线的吞吐。
+ * 可选循环播放，到达末尾后从头开始。
+ */
+
+struct video_source_t {
+    video_source_type_t type;
+    video_playback_t playback;
+    int loop;
+    double fps;                          // 节拍帧率（实时回放）
+    std::string path;
+    cv::VideoCapture cap;                // RTSP / 文件
+    std::vector<std::string> images;     // 图像目录（已排序）
+    size_t next_image;
+    long frame_index;                    // 自起点以来输出的帧数
+    struct timespec start;               // 实时回放的时间起点
+};
+
+static int is_image_file(const std::string &name) {
+    static const char *exts[] = {".jpg", ".jpeg", ".png", ".bmp"};
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); i++) {
+        size_t n = strlen(exts[i]);
+        if (lower.size() >= n && lower.compare(lower.size() - n, n, exts[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+video_source_t* video_source_open(const video_config_t *config) {
+    video_source_t *src = new (std::nothrow) video_source_t();
+    if (!src) return NULL;
+
+    src->type = config->source_type;
+    src->playback = config->source_type == VIDEO_SOURCE_RTSP ? VIDEO_PLAYBACK_REALTIME : config->playback;
+    src->loop = config->source_type != VIDEO_SOURCE_RTSP && config->loop;
+    src->path = config->source_type == VIDEO_SOURCE_RTSP ? config->rtsp_url : config->source_path;
+    src->next_image = 0;
+    src->frame_index = 0;
+    src->fps = config->fps > 0 ? config->fps : 30;
+
+    if (src->type == VIDEO_SOURCE_IMAGES) {
+        std::vector<cv::String> files;
+        cv::glob(src->path + "/*", files, false);
+        for (size_t i = 0; i < files.size(); i++) {
+            if (is_image_file(files[i])) src->images.push_back(files[i]);
+        }
+        std::sort(src->images.begin(), src->images.end());
+        if (src->images.empty()) {
+            LOG_ERROR("Video Source: No images in %s", src->path.c_str());
+            delete src;
+            return NULL;
+        }
+    } else {
+        if (!src->cap.open(src->path)) {
+            LOG_ERROR("Video Source: Failed to open %s", src->path.c_str());
+            delete src;
+            return NULL;
+        }
+        // 文件源优先使用文件自身的帧率
+        double file_fps = src->cap.get(cv::CAP_PROP_FPS);
+        if (src->type == VIDEO_SOURCE_FILE && file_fps > 0) src->fps = file_fps;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &src->start);
+    LOG_INFO("Video Source: Opened %s (%s, %s%s, %.1f fps)", src->path.c_str(),
+             src->type == VIDEO_SOURCE_RTSP ? "rtsp" : (src->type == VIDEO_SOURCE_FILE ? "file" : "images"),
+             src->playback == VIDEO_PLAYBACK_FAST ? "fast" : "realtime", src->loop ? ", loop" : "", src->fps);
+    return src;
+}
+
+void video_source_close(video_source_t *src) {
+    if (!src) return;
+    src->cap.release();
+    delete src;
+}
+
+int video_source_is_fast(const video_source_t *src) {
+    return src && src->playback == VIDEO_PLAYBACK_FAST;
+}
+
+// 回到起点；返回 0 成功
+static int rewind_source(video_source_t *src) {
+    if (src->type == VIDEO_SOURCE_IMAGES) {
+        src->next_image = 0;
+    } else if (!src->cap.set(cv::CAP_PROP_POS_FRAMES, 0)) {
+        // 部分后端不支持定位，重新打开
+        src->cap.release();
+        if (!src->cap.open(src->path)) return -1;
+    }
+    src->frame_index = 0;
+    clock_gettime(CLOCK_MONOTONIC, &src->start);
+    return 0;
+}
+
+// 实时回放：睡到第 frame_index 帧的计划时间（RTSP 由网络自身节拍）
+static void pace(video_source_t *src) {
+    if (src->type == VIDEO_SOURCE_RTSP || src->playback != VIDEO_PLAYBACK_REALTIME) return;
+
+    double offset = src->frame_index / src->fps;
+    struct timespec due = src->start;
+    due.tv_sec += (time_t)offset;
+    due.tv_nsec += (long)((offset - (time_t)offset) * 1e9);
+    if (due.tv_nsec >= 1000000000L) {
+        due.tv_sec++;
+        due.tv_nsec -= 1000000000L;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+}
+
+/**
+ * @brief 读取下一帧到 dst（dst 为池帧的 Mat 头时直接解码到池内存）
+ *
+ * 图像目录经 imread 解码，会产生一次拷贝（imread 不支持写入已有缓冲区）。
+ * @return 0 成功，1 源已结束（未开启循环），-1 读取失败
+ */
+int video_source_read(video_source_t *src, cv::Mat &dst) {
+    if (!src) return -1;
+    pace(src);
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (src->type == VIDEO_SOURCE_IMAGES) {
+            if (src->next_image < src->images.size()) {
+                cv::Mat image = cv::imread(src->images[src->next_image++], cv::IMREAD_COLOR);
+                if (image.empty()) return -1;
+                image.copyTo(dst);
+                src->frame_index++;
+                return 0;
+            }
+        } else if (src->cap.read(dst)) {
+            src->frame_index++;
+            return 0;
+        } else if (src->type == VIDEO_SOURCE_RTSP) {
+            return -1;
+        }
+
+        // 离线源读到末尾
+        if (!src->loop) return 1;
+        if (rewind_source(src) != 0) return -1;
+    }
+    return -1;
+}
@@ -0,0 +1,264 @@
+#include "mec_video.h"
+
+/**
+ * @file video_tracker.c
+ * @brief 单相机多目标跟踪器（图像空间，归一化坐标）
+ *
+ * 每条轨迹带一个恒速预测器；预测位置按关联门限大小分桶到均匀网格，
+ * 每个检测只需检查相邻 3x3 个网格，候选配对按距离全局排序后贪心分配，
+ * 保证一条轨迹每帧最多匹配一个检测、ID 不会重复。
+ * 整体复杂度约为 O(N + M + K log K)，K 为门限内候选对数。
+ * ID 计数器属于跟踪器实例，各相机互不干扰。
+ */
+
+#define TRACKER_MAX_GRID   256
+#define TRACKER_VEL_GAIN   0.5   // 速度更新增益（alpha-beta 中的 beta）
+
+typedef struct {
+    int det_idx;
+    int track_idx;
+    double dist_sq;
+} tracker_candidate_t;
+
+static int grid_cell_of(const video_tracker_t *tracker, double v) {
+    int c = (int)(v * tracker->grid_dim);
+    if (c < 0) c = 0;
+    if (c >= tracker->grid_dim) c = tracker->grid_dim - 1;
+    return c;
+}
+
+video_tracker_t* video_tracker_create(double gate, int max_misses, int max_coast_ms) {
+    if (gate <= 0) return NULL;
+
+    video_tracker_t *tracker = mec_calloc(1, sizeof(video_tracker_t));
+    if (!tracker) return NULL;
+
+    tracker->gate = gate;
+    tracker->max_misses = max_misses;
+    tracker->max_coast = max_coast_ms / 1000.0;
+    tracker->next_id = 1;
+    tracker->grid_dim = (int)ceil(1.0 / gate);
+    if (tracker->grid_dim > TRACKER_MAX_GRID) tracker->grid_dim = TRACKER_MAX_GRID;
+    if (tracker->grid_dim < 1) tracker->grid_dim = 1;
+
+    tracker->capacity = 64;
+    tracker->tracks = mec_malloc(tracker->capacity * sizeof(video_tracklet_t));
+    tracker->next_in_cell = mec_malloc(tracker->capacity * sizeof(int));
+    tracker->cell_head = mec_malloc(tracker->grid_dim * tracker->grid_dim * sizeof(int));
+    tracker->candidate_capacity = 256;
+    tracker->candidates = mec_malloc(tracker->candidate_capacity * sizeof(tracker_candidate_t));
+    tracker->det_match = NULL;
+    tracker->det_capacity = 0;
+    if (!tracker->tracks || !tracker->next_in_cell || !tracker->cell_head || !tracker->candidates) {
+        video_tracker_destroy(tracker);
+        return NULL;
+    }
+    return tracker;
+}
+
+void video_tracker_destroy(video_tracker_t *tracker) {
+    if (!tracker) return;
+    mec_free(tracker->tracks);
+    mec_free(tracker->next_in_cell);
+    mec_free(tracker->cell_head);
+    mec_free(tracker->candidates);
+    mec_free(tracker->det_match);
+    mec_free(tracker);
+}
+
+static int ensure_track_capacity(video_tracker_t *tracker, int needed) {
+    if (needed <= tracker->capacity) return 0;
+    int new_capacity = tracker->capacity * 2;
+    while (new_capacity < needed) new_capacity *= 2;
+    video_tracklet_t *tracks = mec_realloc(tracker->tracks, new_capacity * sizeof(video_tracklet_t));
+    if (!tracks) return -1;
+    tracker->tracks = tracks;
+    int *chain = mec_realloc(tracker->next_in_cell, new_capacity * sizeof(int));
+    if (!chain) return -1;
+    tracker->next_in_cell = chain;
+    tracker->capacity = new_capacity;
+    return 0;
+}
+
+static int push_candidate(video_tracker_t *tracker, int *count, int det_idx, int track_idx, double dist_sq) {
+    if (*count >= tracker->candidate_capacity) {
+        int new_capacity = tracker->candidate_capacity * 2;
+        void *grown = mec_realloc(tracker->candidates, new_capacity * sizeof(tracker_candidate_t));
+        if (!grown) return -1;
+        tracker->candidates = grown;
+        tracker->candidate_capacity = new_capacity;
+    }
+    tracker_candidate_t *c = &((tracker_candidate_t *)tracker->candidates)[(*count)++];
+    c->det_idx = det_idx;
+    c->track_idx = track_idx;
+    c->dist_sq = dist_sq;
+    return 0;
+}
+
+static int compare_candidates(const void *a, const void *b) {
+    double da = ((const tracker_candidate_t *)a)->dist_sq;
+    double db = ((const tracker_candidate_t *)b)->dist_sq;
+    return (da > db) - (da < db);
+}
+
+/**
+ * @brief 用一帧检测结果更新跟踪器，并为每个检测写入稳定的 ID
+ *
+ * 预测位置落在 observed 之外的未匹配轨迹视为“未观测”而非丢失：
+ * 不累计丢失次数，并以预测位置追加到 detections 末尾输出；距最后一次
+ * 匹配超过 max_coast 秒的此类轨迹删除。预测位置离开画面 [0,1)² 的
+ * 未匹配轨迹直接删除。
+ * @param detections 检测结果（position.longitude/latitude 为归一化 x/y），
+ *                   关联后原地改写 id
+ * @param observed 本帧实际检测的归一化区域（NULL 表示整帧）
+ * @param frame_time 帧捕获时间，用于计算 dt
+ */
+int video_tracker_update(video_tracker_t *tracker, track_list_t *detections,
+                         const video_norm_rect_t *observed, const struct timeval *frame_time) {
+    if (!tracker || !detections || !frame_time) return -1;
+
+    double dt = 0;
+    if (tracker->last_time.tv_sec != 0) {
+        dt = (frame_time->tv_sec - tracker->last_time.tv_sec) +
+             (frame_time->tv_usec - tracker->last_time.tv_usec) / 1000000.0;
+        if (dt < 0) dt = 0;
+    }
+    tracker->last_time = *frame_time;
+
+    if (detections->count > tracker->det_capacity) {
+        int *grown = mec_realloc(tracker->det_match, detections->count * sizeof(int));
+        if (!grown) return -1;
+        tracker->det_match = grown;
+        tracker->det_capacity = detections->count;
+    }
+
+    // 1. 恒速预测 + 网格分桶
+    int cells = tracker->grid_dim * tracker->grid_dim;
+    for (int c = 0; c < cells; c++) tracker->cell_head[c] = -1;
+    for (int j = 0; j < tracker->count; j++) {
+        video_tracklet_t *t = &tracker->tracks[j];
+        t->x += t->vx * dt;
+        t->y += t->vy * dt;
+        t->matched = 0;
+        int cell = grid_cell_of(tracker, t->y) * tracker->grid_dim + grid_cell_of(tracker, t->x);
+        tracker->next_in_cell[j] = tracker->cell_head[cell];
+        tracker->cell_head[cell] = j;
+    }
+
+    // 2. 门控：每个检测只检查相邻 3x3 网格；候选表扩容失败时本帧停止门控，
+    //    未完成门控的检测不新建轨迹
+    double gate_sq = tracker->gate * tracker->gate;
+    int cand_count = 0;
+    int gated = detections->count;
+    for (int i = 0; i < detections->count; i++) tracker->det_match[i] = -1;
+    for (int i = 0; i < gated; i++) {
+        double dx0 = detections->tracks[i].position.longitude;
+        double dy0 = detections->tracks[i].position.latitude;
+        int cx = grid_cell_of(tracker, dx0);
+        int cy = grid_cell_of(tracker, dy0);
+
+        for (int gy = cy - 1; gy <= cy + 1 && gated > i; gy++) {
+            if (gy < 0 || gy >= tracker->grid_dim) continue;
+            for (int gx = cx - 1; gx <= cx + 1 && gated > i; gx++) {
+                if (gx < 0 || gx >= tracker->grid_dim) continue;
+                for (int j = tracker->cell_head[gy * tracker->grid_dim + gx]; j >= 0; j = tracker->next_in_cell[j]) {
+                    double dx = dx0 - tracker->tracks[j].x;
+                    double dy = dy0 - tracker->tracks[j].y;
+                    double d2 = dx * dx + dy * dy;
+                    if (d2 < gate_sq && push_candidate(tracker, &cand_count, i, j, d2) != 0) {
+                        LOG_ERROR("Tracker: Candidate allocation failed, gating stopped at %d/%d detections",
+                                  i, detections->count);
+                        gated = i;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // 3. 全局贪心分配
+    tracker_candidate_t *cands = (tracker_candidate_t *)tracker->candidates;
+    qsort(cands, cand_count, sizeof(tracker_candidate_t), compare_candidates);
+    for (int k = 0; k < cand_count; k++) {
+        if (tracker->det_match[cands[k].det_idx] >= 0 || tracker->tracks[cands[k].track_idx].matched) continue;
+        tracker->det_match[cands[k].det_idx] = cands[k].track_idx;
+        tracker->tracks[cands[k].track_idx].matched = 1;
+    }
+
+    // 4. 更新已匹配轨迹；未匹配的检测在尾部新建轨迹
+    int existing = tracker->count;
+    for (int i = 0; i < detections->count; i++) {
+        target_track_t *det = &detections->tracks[i];
+        int j = tracker->det_match[i];
+        if (j >= 0) {
+            video_tracklet_t *t = &tracker->tracks[j];
+            if (dt > 0) {
+                // alpha-beta：以残差修正速度
+                t->vx += TRACKER_VEL_GAIN * (det->position.longitude - t->x) / dt;
+                t->vy += TRACKER_VEL_GAIN * (det->position.latitude - t->y) / dt;
+            }
+            t->x = det->position.longitude;
+            t->y = det->position.latitude;
+            t->hits++;
+            t->misses = 0;
+            t->last_seen = *frame_time;
+            t->last = *det;
+            det->id = t->id;
+        } else if (i < gated) {
+            if (ensure_track_capacity(tracker, tracker->count + 1) != 0) continue;
+            video_tracklet_t *t = &tracker->tracks[tracker->count++];
+            memset(t, 0, sizeof(*t));
+            t->id = tracker->next_id++;
+            t->x = det->position.longitude;
+            t->y = det->position.latitude;
+            t->hits = 1;
+            t->matched = 1;
+            t->last_seen = *frame_time;
+            t->last = *det;
+            det->id = t->id;
+        }
+    }
+
+    // 5. 未观测的轨迹按预测输出；其余未匹配轨迹累计丢失次数。
+    //    出画面、丢失或未观测超限的轨迹删除（与末尾交换，O(1)）
+    for (int j = 0; j < existing && j < tracker->count; j++) {
+        video_tracklet_t *t = &tracker->tracks[j];
+        if (t->matched) continue;
+        int unobserved = observed && (t->x < observed->x0 || t->x >= observed->x1 ||
+                                      t->y < observed->y0 || t->y >= observed->y1);
+        int drop;
+        if (t->x < 0 || t->x >= 1 || t->y < 0 || t->y >= 1) {
+            drop = 1;
+        } else if (unobserved) {
+            double coast = (frame_time->tv_sec - t->last_seen.tv_sec) +
+                           (frame_time->tv_usec - t->last_seen.tv_usec) / 1000000.0;
+            drop = coast > tracker->max_coast;
+        } else {
+            drop = ++t->misses > tracker->max_misses;
+        }
+        if (drop) {
+            tracker->tracks[j] = tracker->tracks[--tracker->count];
+            if (tracker->count < existing) existing--;
+            j--;
+        } else if (unobserved) {
+            target_track_t predicted = t->last;
+            predicted.id = t->id;
+            predicted.position.longitude = t->x;
+            predicted.position.latitude = t->y;
+            predicted.timestamp = *frame_time;
+            track_list_add(detections, &predicted);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 跳过检测的帧：全部轨迹按恒速模型外推并输出，不计丢失
+ *
+ * 出画面或持续未匹配超过 max_coast 的轨迹同样删除。
+ */
+int video_tracker_predict(video_tracker_t *tracker, track_list_t *tracks, const struct timeval *frame_time) {
+    video_norm_rect_t nothing = {0, 0, 0, 0};
+    return video_tracker_update(tracker, tracks, &nothing, frame_time);
+}
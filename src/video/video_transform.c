@@ -0,0 +1,166 @@
+#include "mec_video.h"
+
+/**
+ * @file video_transform.c
+ * @brief 图像坐标 -> 本地 ENU -> WGS84 坐标转换
+ *
+ * 透视矩阵把像素映射到以 site 原点为原点的本地平面坐标（东/北，米），
+ * 再按 site 中预计算的线性化系数转换为经纬度（见 geo.c）。
+ * 批量接口以 SoA 分块处理整个航迹列表；可选的查找网格在标定后
+ * 构建一次，每个目标只需双线性插值（4 次加载 + 若干 FMA）。
+ */
+
+#define TRANSFORM_BATCH 64
+
+int transform_image_to_wgs84(const perspective_transform_t *transform,
+                           const image_coord_t *image_coord,
+                           wgs84_coord_t *wgs84_coord) {
+    if (!transform || !image_coord || !wgs84_coord || !transform->calibrated) {
+        return -1;
+    }
+
+    double x = image_coord->x;
+    double y = image_coord->y;
+
+    // Apply perspective transformation matrix
+    double w = transform->matrix[6] * x + transform->matrix[7] * y + transform->matrix[8];
+    if (fabs(w) < 1e-10) return -1;
+
+    double east = (transform->matrix[0] * x + transform->matrix[1] * y + transform->matrix[2]) / w;
+    double north = (transform->matrix[3] * x + transform->matrix[4] * y + transform->matrix[5]) / w;
+
+    // 未配置原点时 site 为恒等映射，输出本地平面坐标（米）
+    geo_enu_to_wgs84(&transform->site, east, north, wgs84_coord);
+    return 0;
+}
+
+perspective_grid_t* perspective_grid_create(const perspective_transform_t *transform, int width, int height, int cell) {
+    if (!transform || !transform->calibrated || width <= 0 || height <= 0 || cell <= 0) return NULL;
+
+    perspective_grid_t *grid = mec_malloc(sizeof(perspective_grid_t));
+    if (!grid) return NULL;
+
+    grid->width = width;
+    grid->height = height;
+    grid->cell = cell;
+    grid->inv_cell = 1.0f / cell;
+    grid->cols = (width + cell - 1) / cell + 1;
+    grid->rows = (height + cell - 1) / cell + 1;
+    grid->nodes = mec_malloc((size_t)grid->cols * grid->rows * 2 * sizeof(float));
+    if (!grid->nodes) {
+        mec_free(grid);
+        return NULL;
+    }
+
+    double k_north = transform->site.lat_per_north;
+    double k_east = transform->site.lon_per_east;
+
+    // 节点存储相对原点的偏移（度或米），float 足以保证亚厘米精度
+    const double *m = transform->matrix;
+    for (int r = 0; r < grid->rows; r++) {
+        for (int c = 0; c < grid->cols; c++) {
+            double x = c * cell, y = r * cell;
+            double w = m[6] * x + m[7] * y + m[8];
+            if (fabs(w) < 1e-10) w = 1e-10;
+            double east = (m[0] * x + m[1] * y + m[2]) / w;
+            double north = (m[3] * x + m[4] * y + m[5]) / w;
+            float *node = &grid->nodes[(r * grid->cols + c) * 2];
+            node[0] = (float)(north * k_north);
+            node[1] = (float)(east * k_east);
+        }
+    }
+
+    LOG_INFO("Transform: Built %dx%d lookup grid (%d px cells) for %dx%d frames",
+             grid->cols, grid->rows, cell, width, height);
+    return grid;
+}
+
+void perspective_grid_destroy(perspective_grid_t *grid) {
+    if (!grid) return;
+    mec_free(grid->nodes);
+    mec_free(grid);
+}
+
+// 网格路径：双线性插值
+static void grid_project(const perspective_grid_t *grid, const double *restrict px, const double *restrict py,
+                         double *restrict out_a, double *restrict out_b, int n) {
+    const float *nodes = grid->nodes;
+    int cols = grid->cols;
+    float max_x = (float)(grid->cols - 1) - 1e-3f;
+    float max_y = (float)(grid->rows - 1) - 1e-3f;
+
+    for (int i = 0; i < n; i++) {
+        float gx = (float)px[i] * grid->inv_cell;
+        float gy = (float)py[i] * grid->inv_cell;
+        gx = gx < 0 ? 0 : (gx > max_x ? max_x : gx);
+        gy = gy < 0 ? 0 : (gy > max_y ? max_y : gy);
+        int c = (int)gx, r = (int)gy;
+        float fx = gx - c, fy = gy - r;
+
+        const float *n00 = &nodes[(r * cols + c) * 2];
+        const float *n10 = n00 + 2;
+        const float *n01 = n00 + cols * 2;
+        const float *n11 = n01 + 2;
+
+        float a0 = n00[0] + fx * (n10[0] - n00[0]);
+        float a1 = n01[0] + fx * (n11[0] - n01[0]);
+        float b0 = n00[1] + fx * (n10[1] - n00[1]);
+        float b1 = n01[1] + fx * (n11[1] - n01[1]);
+        out_a[i] = a0 + fy * (a1 - a0);
+        out_b[i] = b0 + fy * (b1 - b0);
+    }
+}
+
+// 直接路径：逐点透视除法（无分支，便于编译器向量化）
+static void homography_project(const double *m, double k_north, double k_east,
+                               const double *restrict px, const double *restrict py,
+                               double *restrict out_a, double *restrict out_b, int n) {
+    for (int i = 0; i < n; i++) {
+        double w = m[6] * px[i] + m[7] * py[i] + m[8];
+        double inv_w = 1.0 / (fabs(w) < 1e-10 ? 1e-10 : w);
+        out_a[i] = (m[3] * px[i] + m[4] * py[i] + m[5]) * inv_w * k_north;
+        out_b[i] = (m[0] * px[i] + m[1] * py[i] + m[2]) * inv_w * k_east;
+    }
+}
+
+/**
+ * @brief 批量转换：将整个航迹列表从归一化图像坐标转换到 WGS84
+ *
+ * 输入约定与检测输出一致：position.longitude/latitude 为归一化的 x/y。
+ * 按 TRANSFORM_BATCH 分块收集为 SoA 数组，计算后写回。
+ * @param grid 与帧尺寸匹配时走查找网格，否则（或为 NULL）走直接透视路径
+ */
+int transform_tracks_to_wgs84(const perspective_transform_t *transform, const perspective_grid_t *grid,
+                              track_list_t *tracks, int frame_width, int frame_height) {
+    if (!transform || !tracks || !transform->calibrated) return -1;
+
+    int use_grid = grid && grid->width == frame_width && grid->height == frame_height;
+    const geo_site_t *site = &transform->site;
+    double base_a = site->origin.latitude;
+    double base_b = site->origin.longitude;
+    double alt = site->origin.altitude;
+
+    double px[TRANSFORM_BATCH], py[TRANSFORM_BATCH];
+    double out_a[TRANSFORM_BATCH], out_b[TRANSFORM_BATCH];
+
+    for (int start = 0; start < tracks->count; start += TRANSFORM_BATCH) {
+        int n = tracks->count - start;
+        if (n > TRANSFORM_BATCH) n = TRANSFORM_BATCH;
+        target_track_t *t = &tracks->tracks[start];
+
+        for (int i = 0; i < n; i++) {
+            px[i] = t[i].position.longitude * frame_width;
+            py[i] = t[i].position.latitude * frame_height;
+        }
+
+        if (use_grid) grid_project(grid, px, py, out_a, out_b, n);
+        else homography_project(transform->matrix, site->lat_per_north, site->lon_per_east, px, py, out_a, out_b, n);
+
+        for (int i = 0; i < n; i++) {
+            t[i].position.latitude = base_a + out_a[i];
+            t[i].position.longitude = base_b + out_b[i];
+            t[i].position.altitude = alt;
+        }
+    }
+    return 0;
+}